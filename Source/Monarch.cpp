@@ -1,10 +1,40 @@
 #include "Monarch.hpp"
+#include "MonarchBitPack.hpp"
+#include "MonarchCompression.hpp"
 #include "MonarchException.hpp"
+#include "MonarchIOBounded.hpp"
+#include "MonarchIOCompressed.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <vector>
 
 namespace monarch
 {
 
+    //record buffers are zeroed, so the padding of an aligned record goes to the file as zeros,
+    //and start on anAlignment-byte boundaries, so direct I/O can use them as they are
+    static byte_type* NewRecordBytes( size_t aNBytes, size_t anAlignment )
+    {
+        void* tBytes = NULL;
+        if( posix_memalign( &tBytes, anAlignment < sizeof(void*) ? sizeof(void*) : anAlignment, aNBytes ) != 0 )
+        {
+            throw MonarchException() << "could not allocate <" << aNBytes << "> bytes for a record";
+        }
+        memset( tBytes, 0, aNBytes );
+        return static_cast< byte_type* >( tBytes );
+    }
+
+    //records copied into a batch start on 8-byte boundaries
+    static size_t RoundToWord( size_t aNBytes )
+    {
+        return (aNBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    }
+
     Monarch::Monarch() :
+                fShared( false ),
                 fState( eClosed ),
                 fIO( NULL ),
                 fHeader( NULL ),
@@ -19,12 +49,59 @@ namespace monarch
                 fRecordSeparateOneBytes( NULL ),
                 fRecordSeparateTwo( NULL ),
                 fRecordSeparateTwoBytes( NULL ),
+                fChannelMask( sChannelBoth ),
+                fExtractFunction( NULL ),
+                fBitPacked( false ),
+                fBitDepth( 8 ),
+                fPackedBytes( NULL ),
+                fAlignment( 0 ),
+                fFooter( NULL ),
+                fHeaderNBytes( 0 ),
+                fRecordIndex( 0 ),
+                fBatchBytes( NULL ),
+                fBatchPadded( false ),
+                fReadAt( false ),
+                fReadAtIndex( 0 ),
+                fReadAtOffset( 0 ),
                 fReadFunction( &Monarch::InterleavedFromInterleaved ),
-                fWriteFunction( &Monarch::InterleavedToInterleaved )
+                fWriteFunction( &Monarch::InterleavedToInterleaved ),
+                fNSlots( 0 ),
+                fAsync( false ),
+                fPreallocate( false ),
+                fPreallocateMaxNBytes( 0 ),
+                fPool( NULL ),
+                fSlot( NULL ),
+                fCommitSlot( NULL ),
+                fWriter( NULL ),
+                fZipFunction( NULL ),
+                fUnzipFunction( NULL )
     {
     }
     Monarch::~Monarch()
     {
+        if( fShared == true )
+        {
+            fIO = NULL;
+            fHeader = NULL;
+            fFooter = NULL;
+        }
+
+        if( fWriter != NULL )
+        {
+            delete fWriter;
+            fWriter = NULL;
+        }
+
+        if( fPool != NULL )
+        {
+            //the record buffers belong to the pool's slots
+            delete fPool;
+            fPool = NULL;
+            fRecordInterleavedBytes = NULL;
+            fRecordSeparateOneBytes = NULL;
+            fRecordSeparateTwoBytes = NULL;
+        }
+
         if( fIO != NULL )
         {
             delete fIO;
@@ -40,30 +117,48 @@ namespace monarch
         if( fRecordInterleavedBytes != NULL )
         {
             fRecordInterleaved->~MonarchRecordBytes();
-            delete[] fRecordInterleavedBytes;
+            free( fRecordInterleavedBytes );
             fRecordInterleavedBytes = NULL;
         }
 
         if( fRecordSeparateOneBytes != NULL )
         {
             fRecordSeparateOne->~MonarchRecordBytes();
-            delete[] fRecordSeparateOneBytes;
+            free( fRecordSeparateOneBytes );
             fRecordSeparateOneBytes = NULL;
         }
 
         if( fRecordSeparateTwoBytes != NULL )
         {
             fRecordSeparateTwo->~MonarchRecordBytes();
-            delete[] fRecordSeparateTwoBytes;
+            free( fRecordSeparateTwoBytes );
             fRecordSeparateTwoBytes = NULL;
         }
+
+        if( fPackedBytes != NULL )
+        {
+            free( fPackedBytes );
+            fPackedBytes = NULL;
+        }
+
+        if( fFooter != NULL )
+        {
+            delete fFooter;
+            fFooter = NULL;
+        }
     }
 
-    const Monarch* Monarch::OpenForReading( const string& aFilename )
+    const Monarch* Monarch::OpenForReading( const string& aFilename, IOModeType anIOMode )
     {
         Monarch* tMonarch = new Monarch();
 
-        tMonarch->fIO = new MonarchIO( sAccessRead );
+        tMonarch->fIO = MonarchIO::Create( sAccessRead, anIOMode, aFilename );
+        if( tMonarch->fIO == NULL )
+        {
+            delete tMonarch;
+            throw MonarchException() << "I/O mode <" << anIOMode << "> is not available for reading";
+            return NULL;
+        }
         if( tMonarch->fIO->Open( aFilename ) == false )
         {
             delete tMonarch;
@@ -73,17 +168,64 @@ namespace monarch
 
         tMonarch->fHeader = new MonarchHeader();
         tMonarch->fHeader->SetFilename( aFilename );
+        tMonarch->fFilename = aFilename;
 
         tMonarch->fState = eOpen;
 
         return tMonarch;
     }
 
-    Monarch* Monarch::OpenForWriting( const string& aFilename )
+    Monarch* Monarch::Share() const
+    {
+        if( fState != eReady )
+        {
+            throw MonarchException() << "only a monarch that has read its header can be shared";
+            return NULL;
+        }
+
+        Monarch* tMonarch = new Monarch();
+        tMonarch->fShared = true;
+        tMonarch->fIO = fIO;
+        tMonarch->fHeader = fHeader;
+        tMonarch->fFooter = fFooter;
+        tMonarch->fFilename = fFilename;
+        tMonarch->fHeaderNBytes = fHeaderNBytes;
+        tMonarch->fAlignment = fAlignment;
+        tMonarch->fDataTypeSize = fDataTypeSize;
+        tMonarch->fDataSize = fDataSize;
+        tMonarch->fDataNBytes = fDataNBytes;
+        tMonarch->fInterleavedRecordNBytes = fInterleavedRecordNBytes;
+        tMonarch->fSeparateRecordNBytes = fSeparateRecordNBytes;
+        tMonarch->fReadFunction = fReadFunction;
+        tMonarch->fChannelMask = fChannelMask;
+
+        try
+        {
+            tMonarch->SelectZip();
+            tMonarch->SetupBitPacking();
+            tMonarch->AllocateRecords();
+        }
+        catch( MonarchException& )
+        {
+            delete tMonarch;
+            throw;
+        }
+
+        tMonarch->fState = eReady;
+        return tMonarch;
+    }
+
+    Monarch* Monarch::OpenForWriting( const string& aFilename, IOModeType anIOMode )
     {
         Monarch* tMonarch = new Monarch();
 
-        tMonarch->fIO = new MonarchIO( sAccessWrite );
+        tMonarch->fIO = MonarchIO::Create( sAccessWrite, anIOMode, aFilename );
+        if( tMonarch->fIO == NULL )
+        {
+            delete tMonarch;
+            throw MonarchException() << "I/O mode <" << anIOMode << "> is not available for writing";
+            return NULL;
+        }
         if( tMonarch->fIO->Open( aFilename ) == false )
         {
             delete tMonarch;
@@ -93,6 +235,7 @@ namespace monarch
 
         tMonarch->fHeader = new MonarchHeader();
         tMonarch->fHeader->SetFilename( aFilename );
+        tMonarch->fFilename = aFilename;
 
         tMonarch->fState = eOpen;
 
@@ -122,6 +265,19 @@ namespace monarch
             return;
         }
         delete[] tHeaderBuffer;
+        fHeaderNBytes = sizeof(PreludeType) + tPrelude;
+
+        SetupAlignment();
+        if( fAlignment != 0 && fHeaderNBytes % fAlignment != 0 )
+        {
+            size_t tPadding = fAlignment - fHeaderNBytes % fAlignment;
+            if( fIO->Seek( tPadding ) == false )
+            {
+                throw MonarchException() << "header padding was not skipped properly";
+                return;
+            }
+            fHeaderNBytes += tPadding;
+        }
 
         fDataTypeSize = fHeader->GetDataTypeSize();
 
@@ -131,12 +287,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatSingle << ">" << endl;
             //cout << "  *data size is <" << fDataSize << ">" << endl;
@@ -151,14 +302,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + 2 * fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + (size_t)fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
-            fRecordSeparateTwoBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateTwo = new ( fRecordSeparateTwoBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatSeparateDual << ">" << endl;
             //cout << "  *data size is <" << fDataSize << ">" << endl;
@@ -173,14 +317,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + 2 * fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
-            fRecordSeparateTwoBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateTwo = new ( fRecordSeparateTwoBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatInterleavedDual << ">" << endl;
             //cout << "  *data size is <" << fDataSize << ">" << endl;
@@ -195,6 +332,16 @@ namespace monarch
             return;
         }
 
+        SelectZip();
+        SetupBitPacking();
+        SetupFooter( sAccessRead );
+        SetupBlocks( sAccessRead );
+
+        // the stride of the records in the file, for backends that read ahead by whole records
+        fIO->SetRecordNBytes( StrideNBytes() );
+
+        AllocateRecords();
+
         fState = eReady;
         return;
     }
@@ -222,6 +369,20 @@ namespace monarch
             return;
         }
         delete[] tHeaderBuffer;
+        fHeaderNBytes = sizeof(PreludeType) + tPrelude;
+
+        // the records of an aligned file start on the next boundary
+        SetupAlignment();
+        if( fAlignment != 0 && fHeaderNBytes % fAlignment != 0 )
+        {
+            std::vector< byte_type > tPadding( fAlignment - fHeaderNBytes % fAlignment, 0 );
+            if( fIO->Write( &tPadding[ 0 ], tPadding.size() ) == false )
+            {
+                throw MonarchException() << "header padding was not written properly";
+                return;
+            }
+            fHeaderNBytes += tPadding.size();
+        }
 
         fDataTypeSize = fHeader->GetDataTypeSize();
 
@@ -231,12 +392,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatSingle << ">" << endl;
             //cout << "  *data type size is <" << fDataTypeSize << ">" << endl;
@@ -252,14 +408,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + 2 * fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
-            fRecordSeparateTwoBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateTwo = new ( fRecordSeparateTwoBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatMultiSeparate << ">" << endl;
             //cout << "  *data size is <" << fDataSize << "> and # of data bytes is <" << fDataNBytes << ">" << endl;
@@ -274,14 +423,7 @@ namespace monarch
             fDataNBytes = fDataSize * fDataTypeSize;
 
             fInterleavedRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + 2 * fDataNBytes;
-            fRecordInterleavedBytes = new byte_type[ fInterleavedRecordNBytes ];
-            fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
-
             fSeparateRecordNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType) + fDataNBytes;
-            fRecordSeparateOneBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
-            fRecordSeparateTwoBytes = new byte_type[ fSeparateRecordNBytes ];
-            fRecordSeparateTwo = new ( fRecordSeparateTwoBytes ) MonarchRecordBytes();
 
             //cout << "  *format is <" << sFormatMultiInterleaved << ">" << endl;
             //cout << "  *data size is <" << fDataSize << "> and # of data bytes is <" << fDataNBytes << ">" << endl;
@@ -296,6 +438,36 @@ namespace monarch
             return;
         }
 
+        SelectZip();
+        SetupBitPacking();
+        SetupFooter( sAccessWrite );
+        SetupBlocks( sAccessWrite );
+
+        if( fPreallocate == true )
+        {
+            uint64_t tNBytes = ExpectedNBytes();
+            if( fPreallocateMaxNBytes != 0 && tNBytes > fPreallocateMaxNBytes )
+            {
+                tNBytes = fPreallocateMaxNBytes;
+            }
+            fIO->Preallocate( tNBytes );
+        }
+
+        if( fNSlots > 0 )
+        {
+            fPool = new MonarchRecordPool( fNSlots, BufferNBytes( fInterleavedRecordNBytes ), BufferNBytes( fSeparateRecordNBytes ), fHeader->GetAcquisitionMode() == 2, fAlignment );
+            if( fAsync == true )
+            {
+                fWriter = new MonarchAsyncWriter( fIO, fPool );
+            }
+            fSlot = fPool->Acquire( true );
+            UseSlot( fSlot );
+        }
+        else
+        {
+            AllocateRecords();
+        }
+
         fState = eReady;
         return;
     }
@@ -335,6 +507,58 @@ namespace monarch
         return;
     }
 
+    void Monarch::SetChannelMask( ChannelMaskType aMask ) const
+    {
+        if( aMask == 0 || (aMask & ~sChannelBoth) != 0 )
+        {
+            throw MonarchException() << "invalid channel mask <" << aMask << ">";
+            return;
+        }
+        if( fState == eReady && fHeader->GetAcquisitionMode() == 1 && aMask == sChannelTwo )
+        {
+            throw MonarchException() << "unable to read channel two of a single-channel file";
+            return;
+        }
+        fChannelMask = aMask;
+        return;
+    }
+
+    const byte_type* Monarch::GetChannelData( unsigned aChannel, size_t aDataTypeSize, size_t& aStride ) const
+    {
+        if( fState != eReady )
+        {
+            throw MonarchException() << "channels can only be viewed once the header has been read";
+            return NULL;
+        }
+        if( aDataTypeSize != fDataTypeSize )
+        {
+            throw MonarchException() << "unable to view samples of <" << fDataTypeSize << "> bytes as a type of <" << aDataTypeSize << "> bytes";
+            return NULL;
+        }
+        if( aChannel < 1 || aChannel > fHeader->GetAcquisitionMode() )
+        {
+            throw MonarchException() << "unable to view channel <" << aChannel << "> of a file with acquisition mode <" << fHeader->GetAcquisitionMode() << ">";
+            return NULL;
+        }
+
+        aStride = 1;
+        if( fReadFunction == &Monarch::InterleavedFromSingle )
+        {
+            return fRecordInterleaved->fData;
+        }
+        if( fReadFunction == &Monarch::InterleavedFromInterleaved )
+        {
+            aStride = 2;
+            return fRecordInterleaved->fData + (aChannel - 1) * fDataTypeSize;
+        }
+        // the separate records hold the channels in every other case, including InterleavedFromSeparate
+        if( aChannel == 1 )
+        {
+            return fRecordSeparateOne->fData;
+        }
+        return fRecordSeparateTwo->fData;
+    }
+
     void Monarch::SetInterface( InterfaceModeType aMode )
     {
         if( aMode == sInterfaceInterleaved )
@@ -370,19 +594,564 @@ namespace monarch
         return;
     }
 
+    void Monarch::SelectZip() const
+    {
+        fZipFunction = MonarchZip::GetZip( fDataTypeSize );
+        fUnzipFunction = MonarchZip::GetUnzip( fDataTypeSize );
+        fExtractFunction = MonarchZip::GetExtract( fDataTypeSize );
+        if( fHeader->GetAcquisitionMode() == 2 && (fZipFunction == NULL || fUnzipFunction == NULL) )
+        {
+            throw MonarchException() << "unable to convert two-channel records with data type size <" << fDataTypeSize << ">";
+            return;
+        }
+        return;
+    }
+
+    void Monarch::SetupBitPacking() const
+    {
+        fBitPacked = fHeader->GetBitPacked();
+        fBitDepth = fHeader->GetBitDepth();
+        if( fBitPacked == false )
+        {
+            return;
+        }
+        if( MonarchBitPack::IsSupported( fDataTypeSize, fBitDepth ) == false )
+        {
+            throw MonarchException() << "unable to bit pack samples of bit depth <" << fBitDepth << "> in containers of <" << fDataTypeSize << "> bytes";
+            return;
+        }
+        if( fPackedBytes == NULL )
+        {
+            fPackedBytes = NewRecordBytes( BufferNBytes( fInterleavedRecordNBytes ), fAlignment );
+        }
+        return;
+    }
+
+    void Monarch::SetupAlignment() const
+    {
+        fAlignment = fHeader->GetAlignment();
+        if( fAlignment == 0 )
+        {
+            return;
+        }
+        if( (fAlignment & (fAlignment - 1)) != 0 )
+        {
+            throw MonarchException() << "the alignment <" << fAlignment << "> is not a power of two";
+            return;
+        }
+        if( HasBlocks() == true )
+        {
+            throw MonarchException() << "the records cannot be aligned when they are stored in blocks";
+            return;
+        }
+        return;
+    }
+
+    size_t Monarch::FileNBytes( size_t aNBytes ) const
+    {
+        size_t tNBytes = aNBytes;
+        if( fBitPacked == true )
+        {
+            size_t tHeaderNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType);
+            tNBytes = tHeaderNBytes + MonarchBitPack::PackedNBytes( (aNBytes - tHeaderNBytes) / fDataTypeSize, fBitDepth );
+        }
+        if( fAlignment != 0 )
+        {
+            tNBytes = (tNBytes + fAlignment - 1) / fAlignment * fAlignment;
+        }
+        return tNBytes;
+    }
+
+    size_t Monarch::BufferNBytes( size_t aNBytes ) const
+    {
+        size_t tFileNBytes = FileNBytes( aNBytes );
+        return tFileNBytes > aNBytes ? tFileNBytes : aNBytes;
+    }
+
+    size_t Monarch::StrideNBytes() const
+    {
+        if( fHeader->GetAcquisitionMode() == 2 && fHeader->GetFormatMode() == sFormatMultiSeparate )
+        {
+            return 2 * FileNBytes( fSeparateRecordNBytes );
+        }
+        if( fHeader->GetAcquisitionMode() == 2 )
+        {
+            return FileNBytes( fInterleavedRecordNBytes );
+        }
+        return FileNBytes( fSeparateRecordNBytes );
+    }
+
+    bool Monarch::HasBlocks() const
+    {
+        return fHeader->GetCompression() != sCompressionNone || fHeader->GetBlockIndex() == true || fHeader->GetChecksums() == true;
+    }
+
+    void Monarch::SetupFooter( AccessModeType aMode ) const
+    {
+        fFooter = new MonarchFooter();
+        if( aMode == sAccessWrite )
+        {
+            fFooter->SetRecordNBytes( StrideNBytes() );
+            return;
+        }
+
+        // a file that was not closed, or was written before there were footers, has none
+        if( fFooter->DemarshalFromFile( fFilename ) == false )
+        {
+            delete fFooter;
+            fFooter = NULL;
+        }
+        return;
+    }
+
+    void Monarch::SetupBlocks( AccessModeType aMode ) const
+    {
+        CompressionType tCompression = fHeader->GetCompression();
+        if( HasBlocks() == false )
+        {
+            // the footer follows the records directly, so reading has to stop in front of it
+            if( aMode == sAccessRead && fFooter != NULL )
+            {
+                fIO = new MonarchIOBounded( fIO, fHeaderNBytes, fFooter->GetRecordsNBytes() );
+            }
+            return;
+        }
+        if( MonarchCompression::IsAvailable( tCompression ) == false )
+        {
+            throw MonarchException() << "compression <" << tCompression << "> is not available in this build";
+            return;
+        }
+
+        // unless the header says otherwise, a block holds as many records as fit in at least 1 MB
+        size_t tStrideNBytes = StrideNBytes();
+        size_t tBlockSize = fHeader->GetBlockSize();
+        if( tBlockSize == 0 )
+        {
+            tBlockSize = (1024 * 1024 + tStrideNBytes - 1) / tStrideNBytes;
+        }
+
+        //bit-packed samples do not line up with the data type, so they are not shuffled
+        size_t tElementNBytes = fBitPacked == true ? 1 : fDataTypeSize;
+
+        MonarchIOCompressed* tBlocks = new MonarchIOCompressed( fIO, aMode, tCompression, tElementNBytes, tStrideNBytes, tBlockSize, fHeaderNBytes );
+        fIO = tBlocks;
+        tBlocks->SetChecksums( fHeader->GetChecksums() );
+
+        // without a footer the blocks can still be read one after the other
+        if( fFooter != NULL )
+        {
+            tBlocks->SetFooter( fFooter );
+        }
+        return;
+    }
+
+    uint64_t Monarch::GetNRecords() const
+    {
+        if( fFooter != NULL )
+        {
+            return fFooter->GetNRecords();
+        }
+        if( HasBlocks() == true )
+        {
+            throw MonarchException() << "the records of <" << fFilename << "> are stored in blocks and it has no footer, so they have to be read to be counted";
+        }
+
+        struct stat tStat;
+        if( stat( fFilename.c_str(), &tStat ) != 0 )
+        {
+            throw MonarchException() << "could not find the size of <" << fFilename << ">";
+        }
+        if( (uint64_t) tStat.st_size < fHeaderNBytes )
+        {
+            return 0;
+        }
+        return ((uint64_t) tStat.st_size - fHeaderNBytes) / StrideNBytes();
+    }
+
+    MonarchVerification Monarch::Verify( unsigned aNThreads ) const
+    {
+        if( fHeader->GetChecksums() == false )
+        {
+            throw MonarchException() << "file <" << fFilename << "> was not written with checksums";
+        }
+
+        //the verifier reads the file on its own, so the read position is left alone
+        MonarchVerifier tVerifier;
+        if( tVerifier.Open( fFilename, fHeaderNBytes ) == false )
+        {
+            throw MonarchException() << "could not open <" << fFilename << "> to verify it";
+        }
+        return tVerifier.Verify( fFooter, aNThreads );
+    }
+
+    void Monarch::AllocateRecords() const
+    {
+        fRecordInterleavedBytes = NewRecordBytes( BufferNBytes( fInterleavedRecordNBytes ), fAlignment );
+        fRecordInterleaved = new ( fRecordInterleavedBytes ) MonarchRecordBytes();
+
+        fRecordSeparateOneBytes = NewRecordBytes( BufferNBytes( fSeparateRecordNBytes ), fAlignment );
+        fRecordSeparateOne = new ( fRecordSeparateOneBytes ) MonarchRecordBytes();
+
+        if( fHeader->GetAcquisitionMode() == 2 )
+        {
+            fRecordSeparateTwoBytes = NewRecordBytes( BufferNBytes( fSeparateRecordNBytes ), fAlignment );
+            fRecordSeparateTwo = new ( fRecordSeparateTwoBytes ) MonarchRecordBytes();
+        }
+        return;
+    }
+
     bool Monarch::ReadRecord( int anOffset ) const
     {
-        return (this->*fReadFunction)( anOffset );
+        if( (this->*fReadFunction)( anOffset ) == false )
+        {
+            return false;
+        }
+        fRecordIndex += anOffset + 1;
+        return true;
+    }
+
+    size_t Monarch::BatchStrideNBytes() const
+    {
+        if( fHeader->GetAcquisitionMode() == 2 && fHeader->GetFormatMode() == sFormatMultiSeparate )
+        {
+            return 2 * RoundToWord( FileNBytes( fSeparateRecordNBytes ) );
+        }
+        return RoundToWord( StrideNBytes() );
+    }
+
+    size_t Monarch::BatchRecordNBytes() const
+    {
+        if( fReadFunction == &Monarch::InterleavedFromSingle || fReadFunction == &Monarch::InterleavedFromInterleaved || fReadFunction == &Monarch::InterleavedFromSeparate )
+        {
+            return RoundToWord( fInterleavedRecordNBytes );
+        }
+        return fHeader->GetAcquisitionMode() * RoundToWord( fSeparateRecordNBytes );
+    }
+
+    size_t Monarch::GetBatchNBytes( size_t aNRecords ) const
+    {
+        size_t tStagedNBytes = fIO->IsMapped() == true ? 0 : aNRecords * BatchStrideNBytes();
+        return tStagedNBytes + aNRecords * BatchRecordNBytes();
+    }
+
+    size_t Monarch::ReadRecords( MonarchRecordBatch* aBatch, size_t aNRecords ) const
+    {
+        if( fState != eReady )
+        {
+            throw MonarchException() << "records can only be read once the header has been read";
+            return 0;
+        }
+
+        //the records left can be counted unless they are stored in blocks without a footer; then they are read one by one
+        bool tCounted = fFooter != NULL || HasBlocks() == false;
+        if( tCounted == true )
+        {
+            uint64_t tNRecords = GetNRecords();
+            uint64_t tNLeft = tNRecords > fRecordIndex ? tNRecords - fRecordIndex : 0;
+            if( aNRecords > tNLeft )
+            {
+                aNRecords = tNLeft;
+            }
+        }
+
+        size_t tStagedNBytes = tCounted == true ? aNRecords * StrideNBytes() : 0;
+        size_t tPaddedNBytes = tCounted == true && fIO->IsMapped() == false ? aNRecords * BatchStrideNBytes() : tStagedNBytes;
+        aBatch->Reset( GetBatchNBytes( aNRecords ), fAlignment > sizeof(uint64_t) ? fAlignment : sizeof(uint64_t) );
+        if( aNRecords == 0 )
+        {
+            return 0;
+        }
+
+        const byte_type* tStaged = aBatch->fBuffer;
+        byte_type* tNext = aBatch->fBuffer + (fIO->IsMapped() == true ? 0 : tPaddedNBytes);
+        if( tCounted == true )
+        {
+            if( fIO->IsMapped() == true )
+            {
+                tStaged = fIO->Map( tStagedNBytes );
+                if( tStaged == NULL )
+                {
+                    throw MonarchException() << "could not map the next <" << aNRecords << "> records";
+                    return 0;
+                }
+            }
+            else
+            {
+                if( fIO->Read( aBatch->fBuffer, tStagedNBytes ) == false )
+                {
+                    throw MonarchException() << "could not read the next <" << aNRecords << "> records";
+                    return 0;
+                }
+                //the stored records are moved apart, from the last one down, so that each starts on an 8-byte boundary
+                if( tPaddedNBytes != tStagedNBytes )
+                {
+                    size_t tNPerRecord = fHeader->GetAcquisitionMode() == 2 && fHeader->GetFormatMode() == sFormatMultiSeparate ? 2 : 1;
+                    size_t tStoredNBytes = StrideNBytes() / tNPerRecord;
+                    size_t tPaddedStoredNBytes = BatchStrideNBytes() / tNPerRecord;
+                    for( size_t tStored = aNRecords * tNPerRecord - 1; tStored > 0; --tStored )
+                    {
+                        memmove( aBatch->fBuffer + tStored * tPaddedStoredNBytes, aBatch->fBuffer + tStored * tStoredNBytes, tStoredNBytes );
+                    }
+                }
+                fBatchPadded = true;
+            }
+            fBatchBytes = tStaged;
+        }
+
+        size_t tNRead = 0;
+        try
+        {
+            while( tNRead < aNRecords && (this->*fReadFunction)( 0 ) == true )
+            {
+                AddToBatch( aBatch, tStaged, tPaddedNBytes, tNext );
+                ++tNRead;
+            }
+        }
+        catch( MonarchException& )
+        {
+            fBatchBytes = NULL;
+            fBatchPadded = false;
+            throw;
+        }
+        fBatchBytes = NULL;
+        fBatchPadded = false;
+        fRecordIndex += tNRead;
+
+        //the getters go back to the record buffers rather than into the batch
+        fRecordInterleaved = reinterpret_cast< MonarchRecordBytes* >( fRecordInterleavedBytes );
+        fRecordSeparateOne = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateOneBytes );
+        fRecordSeparateTwo = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateTwoBytes );
+        return tNRead;
+    }
+
+    void Monarch::AddToBatch( MonarchRecordBatch* aBatch, const byte_type* aStaged, size_t aStagedNBytes, byte_type*& aNext ) const
+    {
+        const MonarchRecordBytes* tRecords[ 3 ] = { NULL, NULL, NULL };
+        size_t tNBytes = fSeparateRecordNBytes;
+        if( fReadFunction == &Monarch::InterleavedFromSingle || fReadFunction == &Monarch::InterleavedFromInterleaved || fReadFunction == &Monarch::InterleavedFromSeparate )
+        {
+            tRecords[ 0 ] = fRecordInterleaved;
+            tNBytes = fInterleavedRecordNBytes;
+        }
+        else
+        {
+            if( (fChannelMask & sChannelOne) != 0 )
+            {
+                tRecords[ 1 ] = fRecordSeparateOne;
+            }
+            if( fHeader->GetAcquisitionMode() == 2 && (fChannelMask & sChannelTwo) != 0 )
+            {
+                tRecords[ 2 ] = fRecordSeparateTwo;
+            }
+        }
+
+        //records read where they lie in the batch or the mapping are kept there; converted ones are copied out
+        for( unsigned tIndex = 0; tIndex < 3; ++tIndex )
+        {
+            const byte_type* tBytes = reinterpret_cast< const byte_type* >( tRecords[ tIndex ] );
+            if( tBytes != NULL && (tBytes < aStaged || tBytes >= aStaged + aStagedNBytes) )
+            {
+                memcpy( aNext, tBytes, tNBytes );
+                tRecords[ tIndex ] = reinterpret_cast< const MonarchRecordBytes* >( aNext );
+                aNext += RoundToWord( tNBytes );
+            }
+        }
+        aBatch->fInterleaved.push_back( tRecords[ 0 ] );
+        aBatch->fSeparateOne.push_back( tRecords[ 1 ] );
+        aBatch->fSeparateTwo.push_back( tRecords[ 2 ] );
+        return;
+    }
+
+    bool Monarch::ReadRecordAt( uint64_t anIndex ) const
+    {
+        if( fState != eReady )
+        {
+            throw MonarchException() << "records can only be read once the header has been read";
+            return false;
+        }
+
+        //the footer counts the records for free; a plain file is only measured if a read fails, see IsDone
+        if( fFooter != NULL && anIndex >= GetNRecords() )
+        {
+            return false;
+        }
+
+        //the stream of a block-structured file counts from the first record, a plain file from its first byte
+        fReadAtOffset = (HasBlocks() == true ? 0 : fHeaderNBytes) + anIndex * StrideNBytes();
+        fReadAtIndex = anIndex;
+        fReadAt = true;
+        try
+        {
+            bool tRead = (this->*fReadFunction)( 0 );
+            fReadAt = false;
+            return tRead;
+        }
+        catch( MonarchException& )
+        {
+            fReadAt = false;
+            throw;
+        }
+    }
+
+    uint64_t Monarch::ReadMetadata( MonarchRecordMetadata* aMetadata, uint64_t aFirst, uint64_t aNRecords ) const
+    {
+        if( fState != eReady )
+        {
+            throw MonarchException() << "records can only be read once the header has been read";
+            return 0;
+        }
+        aMetadata->fAcquisitionIds.clear();
+        aMetadata->fRecordIds.clear();
+        aMetadata->fTimes.clear();
+
+        //without a footer the records of a file stored in blocks cannot be counted, so there they end where the reads stop
+        bool tCounted = fFooter != NULL || HasBlocks() == false;
+        if( tCounted == true )
+        {
+            uint64_t tNRecords = GetNRecords();
+            uint64_t tNLeft = tNRecords > aFirst ? tNRecords - aFirst : 0;
+            if( aNRecords > tNLeft )
+            {
+                aNRecords = tNLeft;
+            }
+            aMetadata->fAcquisitionIds.reserve( aNRecords );
+            aMetadata->fRecordIds.reserve( aNRecords );
+            aMetadata->fTimes.reserve( aNRecords );
+        }
+
+        //the first stored record of every record id: the interleaved one, or that of channel one
+        const size_t tPrefixNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType);
+        byte_type tPrefix[ tPrefixNBytes ];
+        uint64_t tStrideNBytes = StrideNBytes();
+        uint64_t tOffset = (HasBlocks() == true ? 0 : fHeaderNBytes) + aFirst * tStrideNBytes;
+        for( uint64_t tIndex = 0; tIndex < aNRecords; ++tIndex, tOffset += tStrideNBytes )
+        {
+            const byte_type* tBytes = tPrefix;
+            if( fIO->IsMapped() == true )
+            {
+                tBytes = fIO->MapAt( tPrefixNBytes, tOffset );
+            }
+            else if( fIO->ReadAt( tPrefix, tPrefixNBytes, tOffset ) == false )
+            {
+                tBytes = NULL;
+            }
+            if( tBytes == NULL )
+            {
+                if( tCounted == false )
+                {
+                    break;
+                }
+                throw MonarchException() << "could not read the metadata of record <" << aFirst + tIndex << ">";
+            }
+
+            AcquisitionIdType tAcquisitionId;
+            RecordIdType tRecordId;
+            TimeType tTime;
+            memcpy( &tAcquisitionId, tBytes, sizeof(AcquisitionIdType) );
+            memcpy( &tRecordId, tBytes + sizeof(AcquisitionIdType), sizeof(RecordIdType) );
+            memcpy( &tTime, tBytes + sizeof(AcquisitionIdType) + sizeof(RecordIdType), sizeof(TimeType) );
+            aMetadata->fAcquisitionIds.push_back( tAcquisitionId );
+            aMetadata->fRecordIds.push_back( tRecordId );
+            aMetadata->fTimes.push_back( tTime );
+        }
+        return aMetadata->fTimes.size();
+    }
+
+    const byte_type* Monarch::FetchBytes( byte_type* aBuffer, size_t aNBytes ) const
+    {
+        if( fBatchBytes != NULL )
+        {
+            const byte_type* tBatchBytes = fBatchBytes;
+            fBatchBytes += fBatchPadded == true ? RoundToWord( aNBytes ) : aNBytes;
+            return tBatchBytes;
+        }
+        const byte_type* tBytes = aBuffer;
+        if( fIO->IsMapped() == true )
+        {
+            tBytes = fReadAt == true ? fIO->MapAt( aNBytes, fReadAtOffset ) : fIO->Map( aNBytes );
+        }
+        else if( (fReadAt == true ? fIO->ReadAt( aBuffer, aNBytes, fReadAtOffset ) : fIO->Read( aBuffer, aNBytes )) == false )
+        {
+            tBytes = NULL;
+        }
+        if( fReadAt == true && tBytes != NULL )
+        {
+            fReadAtOffset += aNBytes;
+        }
+        return tBytes;
+    }
+
+    bool Monarch::SkipBytes( size_t aNBytes ) const
+    {
+        if( fBatchBytes != NULL )
+        {
+            fBatchBytes += fBatchPadded == true ? RoundToWord( aNBytes ) : aNBytes;
+            return true;
+        }
+        if( fReadAt == true )
+        {
+            fReadAtOffset += aNBytes;
+            return true;
+        }
+        return fIO->Seek( aNBytes );
+    }
+
+    bool Monarch::IsDone() const
+    {
+        if( fReadAt == true )
+        {
+            //a record of ReadRecordAt that is past the end of the file is not an error, one that is in the file and cannot be read is;
+            //a file stored in blocks without a footer cannot be counted, so there the end is where the reads stop
+            if( fFooter == NULL && HasBlocks() == true )
+            {
+                return true;
+            }
+            return fReadAtIndex >= GetNRecords();
+        }
+        return fIO->Done() == true;
+    }
+
+    bool Monarch::ReadBytes( MonarchRecordBytes*& aRecord, byte_type* aBytes, size_t aNBytes ) const
+    {
+        if( fBitPacked == true )
+        {
+            size_t tHeaderNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType);
+            const byte_type* tPacked = FetchBytes( fPackedBytes, FileNBytes( aNBytes ) );
+            if( tPacked == NULL )
+            {
+                return false;
+            }
+            // the samples have to be unpacked, so even a mapped file is read into the record buffer
+            aRecord = reinterpret_cast< MonarchRecordBytes* >( aBytes );
+            memcpy( aBytes, tPacked, tHeaderNBytes );
+            MonarchBitPack::Unpack( tPacked + tHeaderNBytes, (aNBytes - tHeaderNBytes) / fDataTypeSize, fDataTypeSize, fBitDepth, aBytes + tHeaderNBytes );
+            return true;
+        }
+        // an aligned record is read with its padding, which the record buffer has room for
+        const byte_type* tBytes = FetchBytes( aBytes, FileNBytes( aNBytes ) );
+        if( tBytes == NULL )
+        {
+            return false;
+        }
+        // a record that lies at an odd offset in the mapping cannot be handed out where it is, since its ids would be misaligned
+        if( tBytes != aBytes && reinterpret_cast< size_t >( tBytes ) % sizeof(uint64_t) != 0 )
+        {
+            memcpy( aBytes, tBytes, aNBytes );
+            tBytes = aBytes;
+        }
+        // a mapping is read-only; records handed out by a reading monarch are const
+        aRecord = reinterpret_cast< MonarchRecordBytes* >( const_cast< byte_type* >( tBytes ) );
+        return true;
     }
 
     bool Monarch::InterleavedFromSingle( int anOffset ) const
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * fInterleavedRecordNBytes;
+            long int aByteOffset = anOffset * FileNBytes( fInterleavedRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -390,9 +1159,9 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( ReadBytes( fRecordInterleaved, fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next single record";
             }
@@ -406,10 +1175,10 @@ namespace monarch
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * 2 * fSeparateRecordNBytes;
+            long int aByteOffset = anOffset * 2 * FileNBytes( fSeparateRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -417,28 +1186,29 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( ReadBytes( fRecordSeparateOne, fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next channel one record";
             }
             return false;
         }
 
-        if( fIO->Read( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
+        if( ReadBytes( fRecordSeparateTwo, fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next channel two record";
             }
             return false;
         }
 
-        fRecordInterleaved->fTime = fRecordSeparateOne->fTime;
+        fRecordInterleaved = reinterpret_cast< MonarchRecordBytes* >( fRecordInterleavedBytes );
+        fRecordInterleaved->fAcquisitionId = fRecordSeparateOne->fAcquisitionId;
         fRecordInterleaved->fRecordId = fRecordSeparateOne->fRecordId;
         fRecordInterleaved->fTime = fRecordSeparateOne->fTime;
-        Zip( fDataSize, fDataTypeSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
+        (*fZipFunction)( fDataSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
 
         return true;
     }
@@ -447,10 +1217,10 @@ namespace monarch
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * fInterleavedRecordNBytes;
+            long int aByteOffset = anOffset * FileNBytes( fInterleavedRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -458,9 +1228,9 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( ReadBytes( fRecordInterleaved, fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next interleaved record";
             }
@@ -474,10 +1244,10 @@ namespace monarch
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * fSeparateRecordNBytes;
+            long int aByteOffset = anOffset * FileNBytes( fSeparateRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -485,9 +1255,9 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( ReadBytes( fRecordSeparateOne, fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next channel one record";
             }
@@ -501,10 +1271,10 @@ namespace monarch
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * 2 * fSeparateRecordNBytes;
+            long int aByteOffset = anOffset * 2 * FileNBytes( fSeparateRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -512,18 +1282,32 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( (fChannelMask & sChannelOne) == 0 )
+        {
+            if( SkipBytes( FileNBytes( fSeparateRecordNBytes ) ) == false )
+            {
+                throw MonarchException() << "could not skip next channel one record";
+            }
+        }
+        else if( ReadBytes( fRecordSeparateOne, fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next channel one record";
             }
             return false;
         }
 
-        if( fIO->Read( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
+        if( (fChannelMask & sChannelTwo) == 0 )
         {
-            if( fIO->Done() != true )
+            if( SkipBytes( FileNBytes( fSeparateRecordNBytes ) ) == false )
+            {
+                throw MonarchException() << "could not skip next channel two record";
+            }
+        }
+        else if( ReadBytes( fRecordSeparateTwo, fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
+        {
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next channel two record";
             }
@@ -537,10 +1321,10 @@ namespace monarch
     {
         if( anOffset != 0 )
         {
-            long int aByteOffset = anOffset * fInterleavedRecordNBytes;
+            long int aByteOffset = anOffset * FileNBytes( fInterleavedRecordNBytes );
             if( fIO->Seek( aByteOffset ) == false )
             {
-                if( fIO->Done() != true )
+                if( IsDone() == false )
                 {
                     cout << "could not seek to requested position" << endl;
                 }
@@ -548,131 +1332,330 @@ namespace monarch
             }
         }
 
-        if( fIO->Read( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( ReadBytes( fRecordInterleaved, fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
-            if( fIO->Done() != true )
+            if( IsDone() == false )
             {
                 throw MonarchException() << "could not read next interleaved record";
             }
             return false;
         }
 
-        fRecordSeparateOne->fTime = fRecordInterleaved->fTime;
-        fRecordSeparateTwo->fTime = fRecordInterleaved->fTime;
+        fRecordSeparateOne = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateOneBytes );
+        fRecordSeparateTwo = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateTwoBytes );
+        fRecordSeparateOne->fAcquisitionId = fRecordInterleaved->fAcquisitionId;
+        fRecordSeparateTwo->fAcquisitionId = fRecordInterleaved->fAcquisitionId;
         fRecordSeparateOne->fRecordId = fRecordInterleaved->fRecordId;
         fRecordSeparateTwo->fRecordId = fRecordInterleaved->fRecordId;
         fRecordSeparateOne->fTime = fRecordInterleaved->fTime;
         fRecordSeparateTwo->fTime = fRecordInterleaved->fTime;
-        Unzip( fDataSize, fDataTypeSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
+        if( fChannelMask == sChannelOne )
+        {
+            (*fExtractFunction)( fDataSize, fRecordSeparateOne->fData, fRecordInterleaved->fData );
+        }
+        else if( fChannelMask == sChannelTwo )
+        {
+            (*fExtractFunction)( fDataSize, fRecordSeparateTwo->fData, fRecordInterleaved->fData + fDataTypeSize );
+        }
+        else
+        {
+            (*fUnzipFunction)( fDataSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
+        }
 
         return true;
     }
 
+    void Monarch::SetRecordSlots( unsigned aNSlots )
+    {
+        if( fState != eOpen )
+        {
+            throw MonarchException() << "the record slots have to be set before the header is written";
+        }
+        fNSlots = aNSlots;
+        return;
+    }
+
+    void Monarch::SetAsyncWriting( unsigned aNSlots )
+    {
+        if( fState != eOpen )
+        {
+            throw MonarchException() << "asynchronous writing has to be set before the header is written";
+        }
+        fNSlots = aNSlots;
+        fAsync = aNSlots > 0;
+        return;
+    }
+
+    void Monarch::SetPreallocation( bool aFlag, uint64_t aMaxNBytes )
+    {
+        if( fState != eOpen )
+        {
+            throw MonarchException() << "preallocation has to be set before the header is written";
+        }
+        fPreallocate = aFlag;
+        fPreallocateMaxNBytes = aMaxNBytes;
+        return;
+    }
+
+    uint64_t Monarch::ExpectedNBytes() const
+    {
+        //the acquisition rate is in MHz and the run duration in ms, so their product is in thousands of samples per channel
+        double tNSamples = fHeader->GetAcquisitionRate() * fHeader->GetRunDuration() * 1000.;
+        if( tNSamples <= 0. || fDataSize == 0 )
+        {
+            return fHeaderNBytes;
+        }
+        uint64_t tNRecords = (uint64_t) ceil( tNSamples / fDataSize );
+        return fHeaderNBytes + tNRecords * StrideNBytes();
+    }
+
+    const MonarchWriteStatistics* Monarch::GetWriteStatistics()
+    {
+        if( fWriter == NULL )
+        {
+            return NULL;
+        }
+        fWriteStatistics = fWriter->GetStatistics();
+        return &fWriteStatistics;
+    }
+
     bool Monarch::WriteRecord()
     {
+        if( fPool != NULL )
+        {
+            CommitSlot( fSlot );
+            fSlot = fPool->Acquire( true );
+            UseSlot( fSlot );
+            return true;
+        }
         return (this->*fWriteFunction)();
     }
 
+    MonarchRecordSlot* Monarch::AcquireRecord()
+    {
+        if( fPool == NULL )
+        {
+            throw MonarchException() << "no record slots have been set up";
+        }
+        return fPool->Acquire( true );
+    }
+
+    bool Monarch::CommitRecord( MonarchRecordSlot* aSlot )
+    {
+        CommitSlot( aSlot );
+        UseSlot( fSlot );
+        return true;
+    }
+
+    void Monarch::CommitSlot( MonarchRecordSlot* aSlot )
+    {
+        UseSlot( aSlot );
+        fCommitSlot = aSlot;
+        fCommitSlot->fNSegments = 0;
+        (this->*fWriteFunction)();
+        fCommitSlot = NULL;
+        fPool->Committed( aSlot );
+
+        if( fWriter != NULL )
+        {
+            fWriter->Commit( aSlot );
+            return;
+        }
+
+        for( unsigned tSegment = 0; tSegment < aSlot->fNSegments; ++tSegment )
+        {
+            if( fIO->Write( aSlot->fSegments[ tSegment ], aSlot->fSegmentNBytes[ tSegment ] ) == false )
+            {
+                fPool->Release( aSlot );
+                throw MonarchException() << "could not write record";
+            }
+        }
+        fPool->Release( aSlot );
+        return;
+    }
+
+    bool Monarch::WriteBytes( const byte_type* aBytes, size_t aNBytes )
+    {
+        size_t tFileNBytes = FileNBytes( aNBytes );
+        fFooter->AddRecordsNBytes( tFileNBytes );
+        if( fBitPacked == true )
+        {
+            size_t tHeaderNBytes = sizeof(AcquisitionIdType) + sizeof(RecordIdType) + sizeof(TimeType);
+            byte_type* tPacked = fPackedBytes;
+            if( fCommitSlot != NULL )
+            {
+                // the slot is not touched again once it is committed, so its buffers can be packed in place
+                tPacked = const_cast< byte_type* >( aBytes );
+            }
+            else
+            {
+                memcpy( tPacked, aBytes, tHeaderNBytes );
+            }
+            size_t tNSamples = (aNBytes - tHeaderNBytes) / fDataTypeSize;
+            MonarchBitPack::Pack( aBytes + tHeaderNBytes, tNSamples, fDataTypeSize, fBitDepth, tPacked + tHeaderNBytes );
+            // the padding of an aligned record may still hold unpacked samples
+            size_t tPackedNBytes = tHeaderNBytes + MonarchBitPack::PackedNBytes( tNSamples, fBitDepth );
+            memset( tPacked + tPackedNBytes, 0, tFileNBytes - tPackedNBytes );
+            aBytes = tPacked;
+        }
+        if( fCommitSlot != NULL )
+        {
+            fCommitSlot->Append( aBytes, tFileNBytes );
+            return true;
+        }
+        return fIO->Write( aBytes, tFileNBytes );
+    }
+
+    void Monarch::UseSlot( MonarchRecordSlot* aSlot )
+    {
+        fRecordInterleavedBytes = aSlot->fInterleavedBytes;
+        fRecordInterleaved = reinterpret_cast< MonarchRecordBytes* >( fRecordInterleavedBytes );
+        fRecordSeparateOneBytes = aSlot->fSeparateOneBytes;
+        fRecordSeparateOne = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateOneBytes );
+        fRecordSeparateTwoBytes = aSlot->fSeparateTwoBytes;
+        fRecordSeparateTwo = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateTwoBytes );
+        return;
+    }
+
     bool Monarch::InterleavedToSingle()
     {
-        if( fIO->Write( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( WriteBytes( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write single record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordInterleaved );
         return true;
     }
 
     bool Monarch::InterleavedToSeparate()
     {
-        fRecordSeparateOne->fTime = fRecordInterleaved->fTime;
-        fRecordSeparateTwo->fTime = fRecordInterleaved->fTime;
+        fRecordSeparateOne->fAcquisitionId = fRecordInterleaved->fAcquisitionId;
+        fRecordSeparateTwo->fAcquisitionId = fRecordInterleaved->fAcquisitionId;
         fRecordSeparateOne->fRecordId = fRecordInterleaved->fRecordId;
         fRecordSeparateTwo->fRecordId = fRecordInterleaved->fRecordId;
-        Unzip( fDataSize, fDataTypeSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
+        fRecordSeparateOne->fTime = fRecordInterleaved->fTime;
+        fRecordSeparateTwo->fTime = fRecordInterleaved->fTime;
+        (*fUnzipFunction)( fDataSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
 
-        if( fIO->Write( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( WriteBytes( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write next channel one record";
             return false;
         }
 
-        if( fIO->Write( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
+        if( WriteBytes( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write next channel two record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordSeparateOne );
         return true;
     }
 
     bool Monarch::InterleavedToInterleaved()
     {
-        if( fIO->Write( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( WriteBytes( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write interleaved record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordInterleaved );
         return true;
     }
 
     bool Monarch::SeparateToSingle()
     {
-        if( fIO->Write( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( WriteBytes( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write single record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordSeparateOne );
         return true;
     }
 
     bool Monarch::SeparateToSeparate()
     {
-        if( fIO->Write( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
+        if( WriteBytes( fRecordSeparateOneBytes, fSeparateRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write next channel one record";
             return false;
         }
 
-        if( fIO->Write( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
+        if( WriteBytes( fRecordSeparateTwoBytes, fSeparateRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write next channel two record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordSeparateOne );
         return true;
     }
 
     bool Monarch::SeparateToInterleaved()
     {
-        fRecordInterleaved->fTime = fRecordSeparateOne->fTime;
+        fRecordInterleaved->fAcquisitionId = fRecordSeparateOne->fAcquisitionId;
         fRecordInterleaved->fRecordId = fRecordSeparateOne->fRecordId;
         fRecordInterleaved->fTime = fRecordSeparateOne->fTime;
-        Zip( fDataSize, fDataTypeSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
+        (*fZipFunction)( fDataSize, fRecordSeparateOne->fData, fRecordSeparateTwo->fData, fRecordInterleaved->fData );
 
-        if( fIO->Write( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
+        if( WriteBytes( fRecordInterleavedBytes, fInterleavedRecordNBytes ) == false )
         {
             throw MonarchException() << "could not write interleaved record";
             return false;
         }
 
+        fFooter->AddRecord( fRecordInterleaved );
         return true;
     }
 
     void Monarch::Close() const
     {
+        bool tMapped = fIO->IsMapped();
         if( fIO->Close() == false )
         {
             throw MonarchException() << "could not close file";
         }
+
+        if( tMapped == true )
+        {
+            //don't leave the records pointing into the released mapping
+            if( fRecordInterleavedBytes != NULL ) fRecordInterleaved = reinterpret_cast< MonarchRecordBytes* >( fRecordInterleavedBytes );
+            if( fRecordSeparateOneBytes != NULL ) fRecordSeparateOne = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateOneBytes );
+            if( fRecordSeparateTwoBytes != NULL ) fRecordSeparateTwo = reinterpret_cast< MonarchRecordBytes* >( fRecordSeparateTwoBytes );
+        }
         return;
     }
 
     void Monarch::Close()
     {
+        if( fWriter != NULL )
+        {
+            try
+            {
+                fWriter->Stop();
+            }
+            catch( MonarchException& )
+            {
+                // the file is still closed, so that its descriptor is not leaked, but it gets no footer
+                fIO->Close();
+                throw;
+            }
+        }
+        // the block stream writes the footer behind the last block when it is closed
+        if( fFooter != NULL && HasBlocks() == false )
+        {
+            fFooter->SetStoredNBytes( fFooter->GetRecordsNBytes() );
+            if( fFooter->MarshalToIO( fIO ) == false )
+            {
+                throw MonarchException() << "could not write footer";
+            }
+        }
         if( fIO->Close() == false )
         {
             throw MonarchException() << "could not close file";
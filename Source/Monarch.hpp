@@ -1,9 +1,15 @@
 #ifndef MONARCH_HPP_
 #define MONARCH_HPP_
 
+#include "MonarchAsyncWriter.hpp"
+#include "MonarchChannelView.hpp"
+#include "MonarchFooter.hpp"
 #include "MonarchIO.hpp"
 #include "MonarchHeader.hpp"
 #include "MonarchRecord.hpp"
+#include "MonarchRecordBatch.hpp"
+#include "MonarchVerifier.hpp"
+#include "MonarchZip.hpp"
 
 #include <string>
 using std::string;
@@ -13,6 +19,9 @@ namespace monarch
 
     class Monarch
     {
+            //a cursor reads through a monarch of its own that shares this one's backend and header
+            friend class MonarchCursor;
+
             //***********************
             // constructors and state
             //***********************
@@ -21,6 +30,12 @@ namespace monarch
             //private to force use of static constructor methods
             Monarch();
 
+            //a monarch that reads the records of this one with positional reads, into buffers of its own.
+            //it shares the backend, the header and the footer, which stay with this monarch.
+            Monarch* Share() const;
+            //true if the backend, the header and the footer belong to another monarch
+            bool fShared;
+
             //current state of monarch
             typedef enum
             {
@@ -42,7 +57,12 @@ namespace monarch
             //this static method opens the file for reading.
             //if the file exists and can be read, this returns a prepared monarch pointer, and memory is allocated for the header.
             //upon successful return monarch is in the eOpen state.
-            static const Monarch* OpenForReading( const string& filename );
+            //anIOMode selects the I/O backend; sIOAuto picks buffered or positional reads from the file size.
+            //with sIOMapped the file is memory mapped and records are not copied: after each ReadRecord the record getters
+            //return pointers straight into the mapping, so they must be called again after every ReadRecord.
+            //the records of a file with an aligned layout (see MonarchHeader::SetAlignment) start on page boundaries
+            //in the mapping, and with sIODirect they are read from the device straight into the record buffers.
+            static const Monarch* OpenForReading( const string& filename, IOModeType anIOMode = sIOAuto );
 
             //this method parses the file for the header contents.
             //if the header demarshalled correctly, this returns and the header may be examined, and memory is allocated for the record.
@@ -53,15 +73,61 @@ namespace monarch
             //get the pointer to the header.
             const MonarchHeader* GetHeader() const;
 
+            //get the pointer to the footer, with the summary of the run and the block index of a file written in blocks.
+            //this is NULL if the file has no footer, because it was not closed properly or was written before there were footers.
+            const MonarchFooter* GetFooter() const;
+
+            //get the number of records (of every channel) in the file without reading them: from the footer when there is one,
+            //and otherwise from the size of the file divided by the size of a record.
+            //an exception is thrown for a file stored in blocks without a footer, which has to be read to count its records.
+            uint64_t GetNRecords() const;
+
+            //check the checksums of every block of a file written with SetChecksums in its header, on aNThreads threads
+            //(0 uses one thread per core). this does not move the read position and can be called any time after ReadHeader.
+            //an exception is thrown if the file has no checksums or cannot be opened again.
+            MonarchVerification Verify( unsigned aNThreads = 0 ) const;
+
             //set the interface type to use
             void SetInterface( InterfaceModeType aMode ) const;
 
+            //select the channels to read through the separate interface (sChannelOne, sChannelTwo or sChannelBoth, the default).
+            //for a separate file the records of the other channel are skipped without being read;
+            //for an interleaved file only the selected channel is deinterleaved.
+            //the separate record of a channel that is not selected is left as it was.
+            //a single-channel file reads its one channel for sChannelBoth; only sChannelTwo is refused.
+            void SetChannelMask( ChannelMaskType aMask ) const;
+
             //this method parses the file for a next record.
             //if the record demarshalled correctly, this returns true and the record is refreshed with content.
             //when the end of the file is reached, this will return false.
             bool ReadRecord( int anOffset = 0 ) const;
 
+            //this method reads the record with index anIndex, counted from the first record of the file, with positional reads.
+            //the position ReadRecord reads from is not moved, and the backend's file offset is not used, so other readers
+            //of the same file descriptor are not disturbed; see MonarchIO::ReadAt for what may run alongside it.
+            //it fills the same records as ReadRecord, so the record getters have to be called again afterwards.
+            //if there is no record with that index, this returns false; if the record is there but cannot be read, an exception is thrown.
+            bool ReadRecordAt( uint64_t anIndex ) const;
+
+            //this method reads up to aNRecords records from where ReadRecord would read next into aBatch, and moves past them.
+            //when the number of records in the file is known (see GetNRecords) they are read with one read, or one mapping,
+            //and records that need no conversion are handed out where they lie; the others are converted into the batch.
+            //this returns the number of records read, which is 0 at the end of the file.
+            //the record getters are not updated.
+            size_t ReadRecords( MonarchRecordBatch* aBatch, size_t aNRecords ) const;
+
+            //number of bytes a caller's buffer for a batch of aNRecords records needs, with the current interface.
+            size_t GetBatchNBytes( size_t aNRecords ) const;
+
+            //this method reads the acquisition id, record id and time of up to aNRecords records from record aFirst on into aMetadata,
+            //without the samples: only the first bytes of each record are read with positional reads, or looked at in the mapping.
+            //the records of a file stored in blocks still have to be decompressed, one block at a time.
+            //like ReadRecordAt it leaves the ReadRecord position and the records alone.
+            //this returns the number of records found, which is less than aNRecords where the file ends; a record that cannot be read throws.
+            uint64_t ReadMetadata( MonarchRecordMetadata* aMetadata, uint64_t aFirst = 0, uint64_t aNRecords = (uint64_t) -1 ) const;
+
             //get the pointer to the current interleaved record.
+            //for a mapped file this pointer changes with every ReadRecord.
             const MonarchRecordBytes* GetRecordInterleaved() const;
 
             //get the pointer to the current separate channel one record.
@@ -70,6 +136,13 @@ namespace monarch
             //get the pointer to the current separate channel two record.
             const MonarchRecordBytes* GetRecordSeparateTwo() const;
 
+            //get a view of channel aChannel (1 or 2) of the current record that neither copies nor deinterleaves it.
+            //with the interleaved interface on an interleaved file the view steps through the interleaved record,
+            //so nothing is unzipped unless the caller copies the channel out with CopyTo.
+            //XType must be as wide as the data type size; like the record getters, call it again after every ReadRecord.
+            template< typename XType >
+            MonarchChannelView< XType > GetChannel( unsigned aChannel ) const;
+
             //close the file pointer.
             void Close() const;
 
@@ -82,7 +155,29 @@ namespace monarch
             //this static method opens the file for writing.
             //if the file exists and can be written, this returns a prepared monarch pointer, and memory is allocated for the header.
             //upon successful return monarch is in the eOpen state.
-            static Monarch* OpenForWriting( const string& filename );
+            //anIOMode selects the I/O backend; sIOMapped is not available for writing.
+            //with sIODirect and an aligned layout (see MonarchHeader::SetAlignment) the records go from the record buffers
+            //to the device without being copied.
+            static Monarch* OpenForWriting( const string& filename, IOModeType anIOMode = sIOAuto );
+
+            //this method sets up a pool of aNSlots record slots for AcquireRecord/CommitRecord.
+            //WriteRecord then works through the slots as well, so the record getters have to be called again after every WriteRecord.
+            //it must be called in the eOpen state, before WriteHeader.
+            void SetRecordSlots( unsigned aNSlots );
+
+            //this method switches on asynchronous writing with a pool of aNSlots record slots.
+            //WriteRecord and CommitRecord then hand the record to a background thread and return at once;
+            //Close drains the queue.
+            //it must be called in the eOpen state, before WriteHeader.
+            void SetAsyncWriting( unsigned aNSlots );
+
+            //this method has WriteHeader reserve space for the whole run, as many records as the run duration, acquisition rate
+            //and record size of the header add up to, so the file system can lay the file out in few extents.
+            //the space that is not written is given back on Close. where the backend or the file system cannot reserve space
+            //(fallocate on Linux), this does nothing. aMaxNBytes, if not 0, caps the space reserved, for a file that only takes
+            //part of the run (see MonarchRollingWriter).
+            //it must be called in the eOpen state, before WriteHeader.
+            void SetPreallocation( bool aFlag, uint64_t aMaxNBytes = 0 );
 
             //this method marshals the current header to the file.
             //if the header marshalled correctly, this returns true, memory is allocated for the record(s).
@@ -99,6 +194,18 @@ namespace monarch
             //if the record marshalled correctly, this returns true.
             bool WriteRecord();
 
+            //take a free slot from the record pool (see SetRecordSlots); blocks until the writer returns one.
+            //fill the slot's records that match the interface in place, then commit it.
+            //several slots may be held at once; they are written in the order they are committed.
+            MonarchRecordSlot* AcquireRecord();
+
+            //this method marshals the records of the slot into the file (or queues them when writing asynchronously).
+            //the slot goes back to the pool once it has been written and must not be touched after this call.
+            bool CommitRecord( MonarchRecordSlot* aSlot );
+
+            //get the back-pressure statistics of the asynchronous writer; NULL when writing synchronously.
+            const MonarchWriteStatistics* GetWriteStatistics();
+
             //get the pointer to the current interleaved record.
             MonarchRecordBytes* GetRecordInterleaved();
 
@@ -112,12 +219,15 @@ namespace monarch
             void Close();
 
         private:
-            //the MonarchIO class wraps a bare C file pointer.
-            MonarchIO* fIO;
+            //the MonarchIO backend (stdio, pread/pwrite, mmap or O_DIRECT), or a compressed stream on top of it.
+            mutable MonarchIO* fIO;
 
             //the header
             mutable MonarchHeader* fHeader;
 
+            //the file as it was opened; the header holds the name it was written with
+            string fFilename;
+
             //size of the native type of the records in bytes
             mutable size_t fDataTypeSize;
 
@@ -147,6 +257,90 @@ namespace monarch
             //pointer to the bytes that hold the second separate record
             mutable byte_type* fRecordSeparateTwoBytes;
 
+            //channels read through the separate interface
+            mutable ChannelMaskType fChannelMask;
+            //single-channel deinterleave kernel, for a channel mask on an interleaved file
+            mutable MonarchExtractFunction fExtractFunction;
+
+            //finds the first sample of channel aChannel in the current record and the distance between its samples
+            const byte_type* GetChannelData( unsigned aChannel, size_t aDataTypeSize, size_t& aStride ) const;
+
+            //true if the samples are stored at the bit depth of the header (see MonarchBitPack)
+            mutable bool fBitPacked;
+            //bits per stored sample
+            mutable unsigned fBitDepth;
+            //scratch record for packing and unpacking, as large as an interleaved record
+            mutable byte_type* fPackedBytes;
+
+            //checks the bit depth and allocates the scratch record when the samples are bit packed
+            void SetupBitPacking() const;
+
+            //boundary the header and every record are padded to in the file; 0 if they are not
+            mutable size_t fAlignment;
+
+            //checks the alignment of the header
+            void SetupAlignment() const;
+
+            //number of bytes a record of aNBytes bytes in memory takes up in the file, with its padding
+            size_t FileNBytes( size_t aNBytes ) const;
+
+            //number of bytes a buffer for a record of aNBytes bytes needs, to hold it as it is in memory or in the file
+            size_t BufferNBytes( size_t aNBytes ) const;
+
+            //number of bytes the records of all channels with one record id take up in the file
+            size_t StrideNBytes() const;
+
+            //true if the header asks for compression, a block index or checksums, which store the records in blocks
+            bool HasBlocks() const;
+
+            //prepares the footer for writing, or finds the footer of the file for reading
+            void SetupFooter( AccessModeType aMode ) const;
+
+            //puts a MonarchIOCompressed on top of the backend when the records are stored in blocks,
+            //or stops reading at the footer when they are not
+            void SetupBlocks( AccessModeType aMode ) const;
+
+            //the footer; NULL when reading a file without one
+            mutable MonarchFooter* fFooter;
+
+            //bytes of the prelude and the header, in front of the records
+            mutable uint64_t fHeaderNBytes;
+
+            //reads the next aNBytes of the file into aBytes, unpacking the samples of a bit-packed file.
+            //for a mapped file nothing is copied; aRecord is pointed into the mapping instead.
+            bool ReadBytes( MonarchRecordBytes*& aRecord, byte_type* aBytes, size_t aNBytes ) const;
+
+            //reads or maps the next aNBytes of the file, into aBuffer if it has to be copied; NULL if they could not be read
+            const byte_type* FetchBytes( byte_type* aBuffer, size_t aNBytes ) const;
+
+            //skips the next aNBytes of the file
+            bool SkipBytes( size_t aNBytes ) const;
+
+            //true if a read came up short because the records ran out, rather than because of an error
+            bool IsDone() const;
+
+            //index of the record ReadRecord reads next, for ReadRecords to know how many are left
+            mutable uint64_t fRecordIndex;
+
+            //while ReadRecords runs, the read functions take the records from here instead of the backend;
+            //records read into the batch are padded to 8 bytes each, mapped ones are not
+            mutable const byte_type* fBatchBytes;
+            mutable bool fBatchPadded;
+
+            //number of bytes one record id takes in a batch it is read into, with each stored record padded to 8 bytes
+            size_t BatchStrideNBytes() const;
+
+            //number of bytes a batch needs for the converted records of one record id
+            size_t BatchRecordNBytes() const;
+
+            //adds the current records to aBatch; those outside the aStagedNBytes bytes at aStaged are copied to aNext
+            void AddToBatch( MonarchRecordBatch* aBatch, const byte_type* aStaged, size_t aStagedNBytes, byte_type*& aNext ) const;
+
+            //while ReadRecordAt runs, the read functions read record fReadAtIndex at fReadAtOffset instead of the backend's position
+            mutable bool fReadAt;
+            mutable uint64_t fReadAtIndex;
+            mutable uint64_t fReadAtOffset;
+
             //the private read functions
             mutable bool (Monarch::*fReadFunction)( int anOffset ) const;
             bool InterleavedFromSingle( int anOffset ) const;
@@ -165,18 +359,43 @@ namespace monarch
             bool SeparateToSeparate();
             bool SeparateToInterleaved();
 
-        private:
-#ifdef __GNUG__
-            static void Zip( const size_t aSize, const size_t aDataTypeSize, const byte_type* __restrict__ aRecordOne, const byte_type* __restrict__ aRecordTwo, byte_type* __restrict__ anInterleavedRecord );
-#else
-            static void Zip( const size_t aSize, const size_t aDataTypeSize, const byte_type*  aRecordOne, const byte_type*  aRecordTwo, byte_type*  anInterleavedRecord );
-#endif
+            //hands record bytes to the file, or to the slot being committed when writing through the record pool.
+            //the samples of a bit-packed file are packed first; in place when the bytes belong to the slot being committed.
+            bool WriteBytes( const byte_type* aBytes, size_t aNBytes );
+
+            //points the records at the buffers of a slot of the record pool
+            void UseSlot( MonarchRecordSlot* aSlot );
+
+            //converts and writes (or queues) the records of a slot
+            void CommitSlot( MonarchRecordSlot* aSlot );
+
+            //allocates the record buffers once the header is known
+            void AllocateRecords() const;
+
+            //number of slots in the record pool (0 for a single set of record buffers)
+            unsigned fNSlots;
+            bool fAsync;
+            //reserve space for the run in WriteHeader, at most fPreallocateMaxNBytes if that is not 0
+            bool fPreallocate;
+            uint64_t fPreallocateMaxNBytes;
+
+            //number of bytes the file is expected to reach, from the run parameters of the header
+            uint64_t ExpectedNBytes() const;
+            //the record pool, if one was requested
+            MonarchRecordPool* fPool;
+            //the slot behind GetRecordInterleaved/GetRecordSeparateOne/GetRecordSeparateTwo
+            MonarchRecordSlot* fSlot;
+            //the slot being committed
+            MonarchRecordSlot* fCommitSlot;
+            //the background writer, if writing asynchronously
+            MonarchAsyncWriter* fWriter;
+            MonarchWriteStatistics fWriteStatistics;
 
-#ifdef __GNUG__
-            static void Unzip( const size_t aSize, const size_t aDataTypeSize, byte_type* __restrict__ aRecordOne, byte_type* __restrict__ aRecordTwo, const byte_type* __restrict__ anInterleavedRecord );
-#else
-            static void Unzip( const size_t aSize, const size_t aDataTypeSize, byte_type*  aRecordOne, byte_type*  aRecordTwo, const byte_type*  anInterleavedRecord );
-#endif
+        private:
+            //picks the interleave and deinterleave kernels for the data type size of the header
+            void SelectZip() const;
+            mutable MonarchZipFunction fZipFunction;
+            mutable MonarchUnzipFunction fUnzipFunction;
 
     };
 
@@ -189,6 +408,11 @@ namespace monarch
         return fHeader;
     }
 
+    inline const MonarchFooter* Monarch::GetFooter() const
+    {
+        return fFooter;
+    }
+
     inline const MonarchRecordBytes* Monarch::GetRecordSeparateOne() const
     {
         return fRecordSeparateOne;
@@ -216,40 +440,12 @@ namespace monarch
         return fRecordInterleaved;
     }
 
-#ifdef __GNUG__
-    inline void Monarch::Zip( const size_t aSize, const size_t aDataTypeSize, const byte_type* __restrict__ aRecordOne, const byte_type* __restrict__ aRecordTwo, byte_type* __restrict__ anInterleavedRecord )
-#else
-    inline void Monarch::Zip( const size_t aSize, const size_t aDataTypeSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord )
-#endif
-    {
-        for( size_t anIndex = 0; anIndex < aSize; anIndex++ )
-        {
-            *anInterleavedRecord = *aRecordOne;
-            anInterleavedRecord += aDataTypeSize;
-            aRecordOne += aDataTypeSize;
-
-            *anInterleavedRecord = *aRecordTwo;
-            anInterleavedRecord += aDataTypeSize;
-            aRecordTwo += aDataTypeSize;
-        }
-    }
-
-#ifdef __GNUG__
-    inline void Monarch::Unzip( const size_t aSize, const size_t aDataTypeSize, byte_type* __restrict__ aRecordOne, byte_type* __restrict__ aRecordTwo, const byte_type* __restrict__ anInterleavedRecord )
-#else
-    inline void Monarch::Unzip( const size_t aSize, const size_t aDataTypeSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord )
-#endif
+    template< typename XType >
+    inline MonarchChannelView< XType > Monarch::GetChannel( unsigned aChannel ) const
     {
-        for( size_t anIndex = 0; anIndex < aSize; anIndex++ )
-        {
-            *aRecordOne = *anInterleavedRecord;
-            anInterleavedRecord += aDataTypeSize;
-            aRecordOne += aDataTypeSize;
-
-            *aRecordTwo = *anInterleavedRecord;
-            anInterleavedRecord += aDataTypeSize;
-            aRecordTwo += aDataTypeSize;
-        }
+        size_t tStride = 1;
+        const byte_type* tData = GetChannelData( aChannel, sizeof(XType), tStride );
+        return MonarchChannelView< XType >( tData, fDataSize, tStride );
     }
 
 }
@@ -0,0 +1,109 @@
+#include "MonarchAsyncWriter.hpp"
+#include "MonarchException.hpp"
+
+namespace monarch
+{
+
+    MonarchAsyncWriter::MonarchAsyncWriter( MonarchIO* anIO, MonarchRecordPool* aPool ) :
+            fIO( anIO ),
+            fPool( aPool ),
+            fQueue( aPool->GetNSlots() ),
+            fRecordsWritten( 0 ),
+            fFailed( 0 ),
+            fRecordsQueued( 0 ),
+            fHighWaterMark( 0 ),
+            fRunning( false )
+    {
+        if( pthread_create( &fThread, NULL, &MonarchAsyncWriter::Run, this ) != 0 )
+        {
+            throw MonarchException() << "could not start the writer thread";
+        }
+        fRunning = true;
+    }
+
+    MonarchAsyncWriter::~MonarchAsyncWriter()
+    {
+        if( fRunning == true )
+        {
+            fQueue.Close();
+            pthread_join( fThread, NULL );
+            fRunning = false;
+        }
+    }
+
+    void MonarchAsyncWriter::Commit( MonarchRecordSlot* aSlot )
+    {
+        if( __atomic_load_n( &fFailed, __ATOMIC_ACQUIRE ) != 0 )
+        {
+            throw MonarchException() << "the writer thread could not write a record";
+        }
+
+        fQueue.Push( aSlot );
+        ++fRecordsQueued;
+
+        unsigned tDepth = fQueue.Size();
+        if( tDepth > fHighWaterMark )
+        {
+            fHighWaterMark = tDepth;
+        }
+        return;
+    }
+
+    void MonarchAsyncWriter::Stop()
+    {
+        if( fRunning == true )
+        {
+            fQueue.Close();
+            pthread_join( fThread, NULL );
+            fRunning = false;
+        }
+        if( __atomic_load_n( &fFailed, __ATOMIC_ACQUIRE ) != 0 )
+        {
+            throw MonarchException() << "the writer thread could not write a record";
+        }
+        return;
+    }
+
+    MonarchWriteStatistics MonarchAsyncWriter::GetStatistics() const
+    {
+        MonarchWriteStatistics tStatistics;
+        tStatistics.fSlots = fPool->GetNSlots();
+        tStatistics.fRecordsQueued = fRecordsQueued;
+        tStatistics.fRecordsWritten = __atomic_load_n( &fRecordsWritten, __ATOMIC_ACQUIRE );
+        tStatistics.fHighWaterMark = fHighWaterMark;
+        tStatistics.fStalls = fPool->GetStalls();
+        tStatistics.fStallTime = fPool->GetStallTime();
+        return tStatistics;
+    }
+
+    void* MonarchAsyncWriter::Run( void* anArgument )
+    {
+        static_cast< MonarchAsyncWriter* >( anArgument )->Execute();
+        return NULL;
+    }
+
+    void MonarchAsyncWriter::Execute()
+    {
+        MonarchRecordSlot* tSlot;
+        while( (tSlot = fQueue.Pop()) != NULL )
+        {
+            //after a failure the queue is still drained so that the producer never waits forever for a slot
+            if( __atomic_load_n( &fFailed, __ATOMIC_RELAXED ) == 0 )
+            {
+                for( unsigned tSegment = 0; tSegment < tSlot->fNSegments; ++tSegment )
+                {
+                    if( fIO->Write( tSlot->fSegments[ tSegment ], tSlot->fSegmentNBytes[ tSegment ] ) == false )
+                    {
+                        __atomic_store_n( &fFailed, 1, __ATOMIC_RELEASE );
+                        break;
+                    }
+                }
+            }
+
+            fPool->Release( tSlot );
+            __atomic_store_n( &fRecordsWritten, fRecordsWritten + 1, __ATOMIC_RELEASE );
+        }
+        return;
+    }
+
+}
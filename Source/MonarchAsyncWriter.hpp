@@ -0,0 +1,65 @@
+#ifndef MONARCHASYNCWRITER_HPP_
+#define MONARCHASYNCWRITER_HPP_
+
+#include "MonarchIO.hpp"
+#include "MonarchRecordPool.hpp"
+#include "MonarchSlotQueue.hpp"
+
+#include <pthread.h>
+
+namespace monarch
+{
+
+    //back-pressure statistics of the asynchronous writer
+    struct MonarchWriteStatistics
+    {
+            //number of slots in the record pool
+            unsigned fSlots;
+            //records handed to the writer thread
+            uint64_t fRecordsQueued;
+            //records the writer thread has finished writing
+            uint64_t fRecordsWritten;
+            //largest number of records waiting for the writer thread
+            unsigned fHighWaterMark;
+            //number of times the producer had to wait for a free slot
+            uint64_t fStalls;
+            //total time spent waiting for a free slot, in ns
+            uint64_t fStallTime;
+    };
+
+    //writes committed record slots on a background thread and returns them to their pool.
+    class MonarchAsyncWriter
+    {
+        public:
+            MonarchAsyncWriter( MonarchIO* anIO, MonarchRecordPool* aPool );
+            ~MonarchAsyncWriter();
+
+            //queue a filled slot for writing; throws if the writer thread has failed.
+            void Commit( MonarchRecordSlot* aSlot );
+
+            //write everything that has been committed and stop the writer thread.
+            //throws if any write failed.
+            void Stop();
+
+            MonarchWriteStatistics GetStatistics() const;
+
+        private:
+            static void* Run( void* anArgument );
+            void Execute();
+
+            MonarchIO* fIO;
+            MonarchRecordPool* fPool;
+            MonarchSlotQueue fQueue;
+
+            volatile uint64_t fRecordsWritten;
+            volatile uint32_t fFailed;
+            uint64_t fRecordsQueued;
+            unsigned fHighWaterMark;
+
+            pthread_t fThread;
+            bool fRunning;
+    };
+
+}
+
+#endif
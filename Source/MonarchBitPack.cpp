@@ -0,0 +1,202 @@
+#include "MonarchBitPack.hpp"
+
+#include <cstring>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define MONARCH_BITPACK_X86
+#include <immintrin.h>
+#define MONARCH_SSSE3 __attribute__(( target( "ssse3" ) ))
+#endif
+
+namespace monarch
+{
+
+    //*****************************************************
+    // generic bit stream kernels
+    //*****************************************************
+
+    static void PackGeneric( const byte_type* aSamples, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aPacked )
+    {
+        const uint64_t tMask = (uint64_t( 1 ) << aBitDepth) - 1;
+        uint64_t tBuffer = 0;
+        unsigned tBits = 0;
+        for( size_t tIndex = 0; tIndex < aNSamples; tIndex++ )
+        {
+            // the sample is read before any of its bits are written, which is what makes packing in place safe
+            uint64_t tSample = 0;
+            memcpy( &tSample, aSamples + tIndex * aDataTypeSize, aDataTypeSize );
+            tSample &= tMask;
+
+            tBuffer |= tSample << tBits;
+            if( tBits + aBitDepth > 64 )
+            {
+                for( unsigned tByte = 0; tByte < 8; tByte++ )
+                {
+                    *aPacked++ = (byte_type) (tBuffer >> (8 * tByte));
+                }
+                tBuffer = tSample >> (64 - tBits);
+                tBits = tBits + aBitDepth - 64;
+            }
+            else
+            {
+                tBits += aBitDepth;
+            }
+            while( tBits >= 8 )
+            {
+                *aPacked++ = (byte_type) tBuffer;
+                tBuffer >>= 8;
+                tBits -= 8;
+            }
+        }
+        if( tBits > 0 )
+        {
+            *aPacked = (byte_type) tBuffer;
+        }
+        return;
+    }
+
+    static void UnpackGeneric( const byte_type* aPacked, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aSamples )
+    {
+        const uint64_t tMask = (uint64_t( 1 ) << aBitDepth) - 1;
+        uint64_t tBuffer = 0;
+        unsigned tBits = 0;
+        for( size_t tIndex = 0; tIndex < aNSamples; tIndex++ )
+        {
+            while( tBits < aBitDepth && tBits <= 56 )
+            {
+                tBuffer |= uint64_t( *aPacked++ ) << tBits;
+                tBits += 8;
+            }
+
+            uint64_t tSample;
+            if( tBits >= aBitDepth )
+            {
+                tSample = tBuffer & tMask;
+                tBuffer >>= aBitDepth;
+                tBits -= aBitDepth;
+            }
+            else
+            {
+                // the sample straddles more than 64 bits of the stream
+                uint64_t tNext = *aPacked++;
+                tSample = (tBuffer | (tNext << tBits)) & tMask;
+                unsigned tUsed = aBitDepth - tBits;
+                tBuffer = tNext >> tUsed;
+                tBits = 8 - tUsed;
+            }
+            memcpy( aSamples + tIndex * aDataTypeSize, &tSample, aDataTypeSize );
+        }
+        return;
+    }
+
+#ifdef MONARCH_BITPACK_X86
+
+    //*****************************************************
+    // 12 bits in 2 bytes
+    //*****************************************************
+
+    //8 samples (16 bytes) become 12 bytes per step
+    static MONARCH_SSSE3 size_t PackTwelveBits( const byte_type* aSamples, size_t aNSamples, byte_type* aPacked )
+    {
+        const __m128i tSampleMask = _mm_set1_epi16( 0x0fff );
+        const __m128i tLowMask = _mm_set1_epi32( 0x0000ffff );
+        const __m128i tHighMask = _mm_set1_epi32( 0x00fff000 );
+        const __m128i tCompact = _mm_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+        size_t tIndex = 0;
+        for( ; tIndex + 8 <= aNSamples; tIndex += 8 )
+        {
+            __m128i tSamples = _mm_and_si128( _mm_loadu_si128( reinterpret_cast< const __m128i* >( aSamples + 2 * tIndex ) ), tSampleMask );
+            // each 32 bit lane holds a pair of samples; move the second one down next to the first
+            __m128i tPairs = _mm_or_si128( _mm_and_si128( tSamples, tLowMask ), _mm_and_si128( _mm_srli_epi32( tSamples, 4 ), tHighMask ) );
+            __m128i tPacked = _mm_shuffle_epi8( tPairs, tCompact );
+            byte_type* tOut = aPacked + (tIndex / 8) * 12;
+            _mm_storel_epi64( reinterpret_cast< __m128i* >( tOut ), tPacked );
+            int tTail = _mm_cvtsi128_si32( _mm_srli_si128( tPacked, 8 ) );
+            memcpy( tOut + 8, &tTail, 4 );
+        }
+        return tIndex;
+    }
+
+    //12 bytes become 8 samples per step; a step reads 16 bytes, so the last few samples are left to the generic kernel
+    static MONARCH_SSSE3 size_t UnpackTwelveBits( const byte_type* aPacked, size_t aNSamples, byte_type* aSamples )
+    {
+        const __m128i tSpread = _mm_setr_epi8( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 );
+        const __m128i tEvenMask = _mm_setr_epi16( 0x0fff, 0, 0x0fff, 0, 0x0fff, 0, 0x0fff, 0 );
+        const __m128i tOddMask = _mm_setr_epi16( 0, 0x0fff, 0, 0x0fff, 0, 0x0fff, 0, 0x0fff );
+        size_t tIndex = 0;
+        for( ; tIndex + 16 <= aNSamples; tIndex += 8 )
+        {
+            __m128i tBytes = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aPacked + (tIndex / 8) * 12 ) );
+            __m128i tSpreadBytes = _mm_shuffle_epi8( tBytes, tSpread );
+            __m128i tSamples = _mm_or_si128( _mm_and_si128( tSpreadBytes, tEvenMask ), _mm_and_si128( _mm_srli_epi16( tSpreadBytes, 4 ), tOddMask ) );
+            _mm_storeu_si128( reinterpret_cast< __m128i* >( aSamples + 2 * tIndex ), tSamples );
+        }
+        return tIndex;
+    }
+
+    static bool HasSSSE3()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports( "ssse3" );
+    }
+
+#endif
+
+    //*****************************************************
+    // interface
+    //*****************************************************
+
+    bool MonarchBitPack::IsSupported( unsigned aDataTypeSize, unsigned aBitDepth )
+    {
+        if( aDataTypeSize != 1 && aDataTypeSize != 2 && aDataTypeSize != 4 && aDataTypeSize != 8 )
+        {
+            return false;
+        }
+        return aBitDepth > 0 && aBitDepth <= 8 * aDataTypeSize;
+    }
+
+    size_t MonarchBitPack::PackedNBytes( size_t aNSamples, unsigned aBitDepth )
+    {
+        return (aNSamples * aBitDepth + 7) / 8;
+    }
+
+    void MonarchBitPack::Pack( const byte_type* aSamples, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aPacked )
+    {
+        if( aBitDepth == 8 * aDataTypeSize )
+        {
+            memmove( aPacked, aSamples, aNSamples * aDataTypeSize );
+            return;
+        }
+        size_t tDone = 0;
+#ifdef MONARCH_BITPACK_X86
+        static const bool sSSSE3 = HasSSSE3();
+        if( sSSSE3 == true && aDataTypeSize == 2 && aBitDepth == 12 )
+        {
+            tDone = PackTwelveBits( aSamples, aNSamples, aPacked );
+        }
+#endif
+        // the vector kernels always stop on a byte boundary of the packed stream
+        PackGeneric( aSamples + tDone * aDataTypeSize, aNSamples - tDone, aDataTypeSize, aBitDepth, aPacked + (tDone * aBitDepth) / 8 );
+        return;
+    }
+
+    void MonarchBitPack::Unpack( const byte_type* aPacked, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aSamples )
+    {
+        if( aBitDepth == 8 * aDataTypeSize )
+        {
+            memcpy( aSamples, aPacked, aNSamples * aDataTypeSize );
+            return;
+        }
+        size_t tDone = 0;
+#ifdef MONARCH_BITPACK_X86
+        static const bool sSSSE3 = HasSSSE3();
+        if( sSSSE3 == true && aDataTypeSize == 2 && aBitDepth == 12 )
+        {
+            tDone = UnpackTwelveBits( aPacked, aNSamples, aSamples );
+        }
+#endif
+        UnpackGeneric( aPacked + (tDone * aBitDepth) / 8, aNSamples - tDone, aDataTypeSize, aBitDepth, aSamples + tDone * aDataTypeSize );
+        return;
+    }
+
+}
@@ -0,0 +1,34 @@
+#ifndef MONARCHBITPACK_HPP_
+#define MONARCHBITPACK_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <cstddef>
+
+namespace monarch
+{
+
+    //packs samples held in aDataTypeSize-byte containers down to aBitDepth bits each, and back.
+    //the packed samples form a little-endian bit stream: sample i takes bits [i * aBitDepth, (i + 1) * aBitDepth).
+    //bits of a sample above aBitDepth are dropped when packing and come back as zeros.
+    //12-bit samples in 2-byte containers, the common digitizer case, have vector kernels.
+    class MonarchBitPack
+    {
+        public:
+            //true if aBitDepth samples can be packed out of aDataTypeSize-byte containers
+            static bool IsSupported( unsigned aDataTypeSize, unsigned aBitDepth );
+
+            //number of bytes that aNSamples packed samples take up
+            static size_t PackedNBytes( size_t aNSamples, unsigned aBitDepth );
+
+            //pack aNSamples samples from aSamples into aPacked.
+            //aPacked may be the same buffer as aSamples; the samples are then packed in place.
+            static void Pack( const byte_type* aSamples, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aPacked );
+
+            //unpack aNSamples samples from aPacked into aSamples; the buffers may not overlap.
+            static void Unpack( const byte_type* aPacked, size_t aNSamples, unsigned aDataTypeSize, unsigned aBitDepth, byte_type* aSamples );
+    };
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef MONARCHCHANNELVIEW_HPP_
+#define MONARCHCHANNELVIEW_HPP_
+
+#include "MonarchException.hpp"
+#include "MonarchTypes.hpp"
+
+#include <cstring>
+
+namespace monarch
+{
+
+    //read-only view of the samples of one channel of a record, without copying them.
+    //aStride is the distance between consecutive samples in samples: 2 for a channel of an interleaved record, 1 otherwise.
+    //XType must be as wide as the data type size of the file (uint8_t, uint16_t, uint32_t or uint64_t).
+    //the view points into the record buffers, so it is only good until the next ReadRecord.
+    template< typename XType >
+    class MonarchChannelView
+    {
+        public:
+            class Iterator
+            {
+                public:
+                    Iterator( const byte_type* aData, size_t aStride ) :
+                        fData( aData ),
+                        fStride( aStride * sizeof(XType) )
+                    {
+                    }
+
+                    XType operator*() const
+                    {
+                        XType tSample;
+                        memcpy( &tSample, fData, sizeof(XType) );
+                        return tSample;
+                    }
+                    Iterator& operator++()
+                    {
+                        fData += fStride;
+                        return *this;
+                    }
+                    Iterator operator++( int )
+                    {
+                        Iterator tPrevious( *this );
+                        fData += fStride;
+                        return tPrevious;
+                    }
+                    Iterator& operator+=( size_t aCount )
+                    {
+                        fData += aCount * fStride;
+                        return *this;
+                    }
+                    bool operator==( const Iterator& anIterator ) const
+                    {
+                        return fData == anIterator.fData;
+                    }
+                    bool operator!=( const Iterator& anIterator ) const
+                    {
+                        return fData != anIterator.fData;
+                    }
+
+                private:
+                    const byte_type* fData;
+                    size_t fStride;
+            };
+
+        public:
+            MonarchChannelView( const byte_type* aData, size_t aSize, size_t aStride ) :
+                fData( aData ),
+                fSize( aSize ),
+                fStride( aStride )
+            {
+            }
+            ~MonarchChannelView()
+            {
+            }
+
+            //number of samples in the channel
+            size_t size() const
+            {
+                return fSize;
+            }
+
+            //sample anIndex, without bounds checking
+            XType operator[]( size_t anIndex ) const
+            {
+                XType tSample;
+                memcpy( &tSample, fData + anIndex * fStride * sizeof(XType), sizeof(XType) );
+                return tSample;
+            }
+
+            //sample anIndex; throws if anIndex is out of range
+            XType at( size_t anIndex ) const
+            {
+                if( anIndex >= fSize )
+                {
+                    throw MonarchException() << "sample <" << anIndex << "> is out of range for a channel of <" << fSize << "> samples";
+                }
+                return (*this)[ anIndex ];
+            }
+
+            Iterator begin() const
+            {
+                return Iterator( fData, fStride );
+            }
+            Iterator end() const
+            {
+                return Iterator( fData + fSize * fStride * sizeof(XType), fStride );
+            }
+
+            //true if the samples are adjacent in memory (the channel was not read from an interleaved record)
+            bool IsContiguous() const
+            {
+                return fStride == 1;
+            }
+
+            //the first sample of the channel
+            const byte_type* GetData() const
+            {
+                return fData;
+            }
+
+            //copy the samples into anArray, which must hold size() samples;
+            //this is where a channel of an interleaved record is deinterleaved.
+            void CopyTo( XType* anArray ) const
+            {
+                if( fStride == 1 )
+                {
+                    memcpy( anArray, fData, fSize * sizeof(XType) );
+                    return;
+                }
+                const byte_type* tData = fData;
+                const size_t tStep = fStride * sizeof(XType);
+                for( size_t tIndex = 0; tIndex < fSize; tIndex++ )
+                {
+                    memcpy( anArray + tIndex, tData, sizeof(XType) );
+                    tData += tStep;
+                }
+                return;
+            }
+
+        private:
+            const byte_type* fData;
+            size_t fSize;
+            size_t fStride;
+    };
+
+}
+
+#endif
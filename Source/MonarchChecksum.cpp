@@ -0,0 +1,111 @@
+#include "MonarchChecksum.hpp"
+
+#include <cstring>
+
+#include <pthread.h>
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define MONARCH_CHECKSUM_X86
+#include <immintrin.h>
+#define MONARCH_SSE42 __attribute__(( target( "sse4.2" ) ))
+#endif
+
+namespace monarch
+{
+
+    //reflected Castagnoli polynomial
+    static const uint32_t sPolynomial = 0x82f63b78;
+
+    //slicing-by-8 tables for the software fallback
+    static uint32_t sTable[ 8 ][ 256 ];
+    static bool sAccelerated = false;
+    static pthread_once_t sOnce = PTHREAD_ONCE_INIT;
+
+    static void Initialize()
+    {
+        for( uint32_t tByte = 0; tByte < 256; tByte++ )
+        {
+            uint32_t tCrc = tByte;
+            for( unsigned tBit = 0; tBit < 8; tBit++ )
+            {
+                tCrc = (tCrc >> 1) ^ ((tCrc & 1) ? sPolynomial : 0);
+            }
+            sTable[ 0 ][ tByte ] = tCrc;
+        }
+        for( uint32_t tByte = 0; tByte < 256; tByte++ )
+        {
+            for( unsigned tSlice = 1; tSlice < 8; tSlice++ )
+            {
+                sTable[ tSlice ][ tByte ] = (sTable[ tSlice - 1 ][ tByte ] >> 8) ^ sTable[ 0 ][ sTable[ tSlice - 1 ][ tByte ] & 0xff ];
+            }
+        }
+#ifdef MONARCH_CHECKSUM_X86
+        __builtin_cpu_init();
+        sAccelerated = __builtin_cpu_supports( "sse4.2" );
+#endif
+        return;
+    }
+
+    static uint32_t Crc32cTable( const byte_type* aData, size_t aNBytes, uint32_t aCrc )
+    {
+        while( aNBytes >= 8 )
+        {
+            uint64_t tWord;
+            memcpy( &tWord, aData, 8 );
+            tWord ^= aCrc;
+            aCrc = sTable[ 7 ][ tWord & 0xff ] ^ sTable[ 6 ][ (tWord >> 8) & 0xff ] ^ sTable[ 5 ][ (tWord >> 16) & 0xff ] ^ sTable[ 4 ][ (tWord >> 24) & 0xff ] ^
+                   sTable[ 3 ][ (tWord >> 32) & 0xff ] ^ sTable[ 2 ][ (tWord >> 40) & 0xff ] ^ sTable[ 1 ][ (tWord >> 48) & 0xff ] ^ sTable[ 0 ][ tWord >> 56 ];
+            aData += 8;
+            aNBytes -= 8;
+        }
+        while( aNBytes > 0 )
+        {
+            aCrc = (aCrc >> 8) ^ sTable[ 0 ][ (aCrc ^ *aData) & 0xff ];
+            aData++;
+            aNBytes--;
+        }
+        return aCrc;
+    }
+
+#ifdef MONARCH_CHECKSUM_X86
+    static MONARCH_SSE42 uint32_t Crc32cSSE42( const byte_type* aData, size_t aNBytes, uint32_t aCrc )
+    {
+        uint64_t tCrc = aCrc;
+        while( aNBytes >= 8 )
+        {
+            uint64_t tWord;
+            memcpy( &tWord, aData, 8 );
+            tCrc = _mm_crc32_u64( tCrc, tWord );
+            aData += 8;
+            aNBytes -= 8;
+        }
+        while( aNBytes > 0 )
+        {
+            tCrc = _mm_crc32_u8( (uint32_t) tCrc, *aData );
+            aData++;
+            aNBytes--;
+        }
+        return (uint32_t) tCrc;
+    }
+#endif
+
+    uint32_t MonarchChecksum::Crc32c( const byte_type* aData, size_t aNBytes, uint32_t aChecksum )
+    {
+        pthread_once( &sOnce, &Initialize );
+        uint32_t tCrc = ~aChecksum;
+#ifdef MONARCH_CHECKSUM_X86
+        if( sAccelerated == true )
+        {
+            return ~Crc32cSSE42( aData, aNBytes, tCrc );
+        }
+#endif
+        return ~Crc32cTable( aData, aNBytes, tCrc );
+    }
+
+    bool MonarchChecksum::IsAccelerated()
+    {
+        pthread_once( &sOnce, &Initialize );
+        return sAccelerated;
+    }
+
+}
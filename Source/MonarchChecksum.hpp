@@ -0,0 +1,26 @@
+#ifndef MONARCHCHECKSUM_HPP_
+#define MONARCHCHECKSUM_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <cstddef>
+
+namespace monarch
+{
+
+    //CRC32C (Castagnoli) checksums of the blocks of a file written with checksums.
+    //the SSE4.2 crc32 instruction is used where the processor has it, and a table otherwise.
+    class MonarchChecksum
+    {
+        public:
+            //extend aChecksum, the checksum of the bytes before, over aNBytes bytes of aData.
+            //start a new checksum with 0.
+            static uint32_t Crc32c( const byte_type* aData, size_t aNBytes, uint32_t aChecksum = 0 );
+
+            //true if Crc32c runs on the crc32 instruction
+            static bool IsAccelerated();
+    };
+
+}
+
+#endif
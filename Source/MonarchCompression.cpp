@@ -0,0 +1,209 @@
+#include "MonarchCompression.hpp"
+
+#include <cstring>
+
+#ifdef Monarch_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef Monarch_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef Monarch_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace monarch
+{
+
+    //noisy digitizer data gains little from the slower levels
+    static const int sZstdLevel = 1;
+    static const int sZlibLevel = 1;
+
+    bool MonarchCompression::IsAvailable( CompressionType aCompression )
+    {
+        switch( aCompression )
+        {
+            case sCompressionNone:
+                return true;
+#ifdef Monarch_HAVE_LZ4
+            case sCompressionLZ4:
+                return true;
+#endif
+#ifdef Monarch_HAVE_ZSTD
+            case sCompressionZstd:
+                return true;
+#endif
+#ifdef Monarch_HAVE_ZLIB
+            case sCompressionZlib:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    size_t MonarchCompression::Bound( CompressionType aCompression, size_t aNBytes )
+    {
+        switch( aCompression )
+        {
+#ifdef Monarch_HAVE_LZ4
+            case sCompressionLZ4:
+                return LZ4_compressBound( (int) aNBytes );
+#endif
+#ifdef Monarch_HAVE_ZSTD
+            case sCompressionZstd:
+                return ZSTD_compressBound( aNBytes );
+#endif
+#ifdef Monarch_HAVE_ZLIB
+            case sCompressionZlib:
+                return compressBound( aNBytes );
+#endif
+            default:
+                return aNBytes;
+        }
+    }
+
+    size_t MonarchCompression::Compress( CompressionType aCompression, const byte_type* aSource, size_t aNBytes, byte_type* aDestination, size_t aCapacity )
+    {
+        switch( aCompression )
+        {
+#ifdef Monarch_HAVE_LZ4
+            case sCompressionLZ4:
+            {
+                int tResult = LZ4_compress_default( reinterpret_cast< const char* >( aSource ), reinterpret_cast< char* >( aDestination ), (int) aNBytes, (int) aCapacity );
+                return tResult > 0 ? (size_t) tResult : 0;
+            }
+#endif
+#ifdef Monarch_HAVE_ZSTD
+            case sCompressionZstd:
+            {
+                size_t tResult = ZSTD_compress( aDestination, aCapacity, aSource, aNBytes, sZstdLevel );
+                return ZSTD_isError( tResult ) ? 0 : tResult;
+            }
+#endif
+#ifdef Monarch_HAVE_ZLIB
+            case sCompressionZlib:
+            {
+                uLongf tResult = aCapacity;
+                if( compress2( aDestination, &tResult, aSource, aNBytes, sZlibLevel ) != Z_OK )
+                {
+                    return 0;
+                }
+                return tResult;
+            }
+#endif
+            default:
+                (void) aSource;
+                (void) aNBytes;
+                (void) aDestination;
+                (void) aCapacity;
+                return 0;
+        }
+    }
+
+    bool MonarchCompression::Decompress( CompressionType aCompression, const byte_type* aSource, size_t aNBytes, byte_type* aDestination, size_t aRawNBytes )
+    {
+        switch( aCompression )
+        {
+            case sCompressionNone:
+                if( aNBytes != aRawNBytes )
+                {
+                    return false;
+                }
+                memcpy( aDestination, aSource, aNBytes );
+                return true;
+#ifdef Monarch_HAVE_LZ4
+            case sCompressionLZ4:
+                return LZ4_decompress_safe( reinterpret_cast< const char* >( aSource ), reinterpret_cast< char* >( aDestination ), (int) aNBytes, (int) aRawNBytes ) == (int) aRawNBytes;
+#endif
+#ifdef Monarch_HAVE_ZSTD
+            case sCompressionZstd:
+                return ZSTD_decompress( aDestination, aRawNBytes, aSource, aNBytes ) == aRawNBytes;
+#endif
+#ifdef Monarch_HAVE_ZLIB
+            case sCompressionZlib:
+            {
+                uLongf tResult = aRawNBytes;
+                return uncompress( aDestination, &tResult, aSource, aNBytes ) == Z_OK && tResult == aRawNBytes;
+            }
+#endif
+            default:
+                return false;
+        }
+    }
+
+    template< size_t XElementNBytes >
+    static void ShuffleElements( const byte_type* aSource, size_t aNElements, byte_type* aDestination )
+    {
+        for( size_t tByte = 0; tByte < XElementNBytes; tByte++ )
+        {
+            byte_type* tPlane = aDestination + tByte * aNElements;
+            for( size_t tElement = 0; tElement < aNElements; tElement++ )
+            {
+                tPlane[ tElement ] = aSource[ tElement * XElementNBytes + tByte ];
+            }
+        }
+        return;
+    }
+
+    template< size_t XElementNBytes >
+    static void UnshuffleElements( const byte_type* aSource, size_t aNElements, byte_type* aDestination )
+    {
+        for( size_t tByte = 0; tByte < XElementNBytes; tByte++ )
+        {
+            const byte_type* tPlane = aSource + tByte * aNElements;
+            for( size_t tElement = 0; tElement < aNElements; tElement++ )
+            {
+                aDestination[ tElement * XElementNBytes + tByte ] = tPlane[ tElement ];
+            }
+        }
+        return;
+    }
+
+    void MonarchCompression::Shuffle( const byte_type* aSource, size_t aNBytes, size_t anElementNBytes, byte_type* aDestination )
+    {
+        size_t tNElements = aNBytes / anElementNBytes;
+        size_t tShuffled = tNElements * anElementNBytes;
+        switch( anElementNBytes )
+        {
+            case 2:
+                ShuffleElements< 2 >( aSource, tNElements, aDestination );
+                break;
+            case 4:
+                ShuffleElements< 4 >( aSource, tNElements, aDestination );
+                break;
+            case 8:
+                ShuffleElements< 8 >( aSource, tNElements, aDestination );
+                break;
+            default:
+                tShuffled = 0;
+                break;
+        }
+        memcpy( aDestination + tShuffled, aSource + tShuffled, aNBytes - tShuffled );
+        return;
+    }
+
+    void MonarchCompression::Unshuffle( const byte_type* aSource, size_t aNBytes, size_t anElementNBytes, byte_type* aDestination )
+    {
+        size_t tNElements = aNBytes / anElementNBytes;
+        size_t tShuffled = tNElements * anElementNBytes;
+        switch( anElementNBytes )
+        {
+            case 2:
+                UnshuffleElements< 2 >( aSource, tNElements, aDestination );
+                break;
+            case 4:
+                UnshuffleElements< 4 >( aSource, tNElements, aDestination );
+                break;
+            case 8:
+                UnshuffleElements< 8 >( aSource, tNElements, aDestination );
+                break;
+            default:
+                tShuffled = 0;
+                break;
+        }
+        memcpy( aDestination + tShuffled, aSource + tShuffled, aNBytes - tShuffled );
+        return;
+    }
+
+}
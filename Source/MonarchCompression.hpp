@@ -0,0 +1,38 @@
+#ifndef MONARCHCOMPRESSION_HPP_
+#define MONARCHCOMPRESSION_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <cstddef>
+
+namespace monarch
+{
+
+    //the codecs and filters behind compressed files (see MonarchIOCompressed).
+    //lz4, zstd and zlib are optional; IsAvailable tells whether this build has a codec.
+    class MonarchCompression
+    {
+        public:
+            //true if aCompression can be written and read by this build
+            static bool IsAvailable( CompressionType aCompression );
+
+            //largest number of bytes that aNBytes bytes can compress to
+            static size_t Bound( CompressionType aCompression, size_t aNBytes );
+
+            //compress aNBytes bytes from aSource into aDestination, which holds aCapacity bytes.
+            //returns the compressed size, or 0 if the codec failed.
+            static size_t Compress( CompressionType aCompression, const byte_type* aSource, size_t aNBytes, byte_type* aDestination, size_t aCapacity );
+
+            //decompress aNBytes bytes from aSource into the aRawNBytes bytes of aDestination.
+            //returns false unless exactly aRawNBytes bytes come out.
+            static bool Decompress( CompressionType aCompression, const byte_type* aSource, size_t aNBytes, byte_type* aDestination, size_t aRawNBytes );
+
+            //gather byte k of every anElementNBytes-byte element into the k-th plane of aDestination, and back.
+            //the bytes past the last whole element are copied as they are.
+            static void Shuffle( const byte_type* aSource, size_t aNBytes, size_t anElementNBytes, byte_type* aDestination );
+            static void Unshuffle( const byte_type* aSource, size_t aNBytes, size_t anElementNBytes, byte_type* aDestination );
+    };
+
+}
+
+#endif
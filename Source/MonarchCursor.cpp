@@ -0,0 +1,77 @@
+#include "MonarchCursor.hpp"
+
+namespace monarch
+{
+
+    MonarchCursor::MonarchCursor( const Monarch* aMonarch ) :
+            fReader( aMonarch->Share() ),
+            fIndex( 0 )
+    {
+    }
+    MonarchCursor::~MonarchCursor()
+    {
+        delete fReader;
+    }
+
+    const MonarchHeader* MonarchCursor::GetHeader() const
+    {
+        return fReader->GetHeader();
+    }
+
+    void MonarchCursor::SetInterface( InterfaceModeType aMode )
+    {
+        fReader->SetInterface( aMode );
+        return;
+    }
+
+    void MonarchCursor::SetChannelMask( ChannelMaskType aMask )
+    {
+        fReader->SetChannelMask( aMask );
+        return;
+    }
+
+    bool MonarchCursor::ReadRecord( int anOffset )
+    {
+        if( anOffset < 0 && (uint64_t) -anOffset > fIndex )
+        {
+            return false;
+        }
+        uint64_t tIndex = fIndex + anOffset;
+        if( fReader->ReadRecordAt( tIndex ) == false )
+        {
+            return false;
+        }
+        fIndex = tIndex + 1;
+        return true;
+    }
+
+    bool MonarchCursor::ReadRecordAt( uint64_t anIndex )
+    {
+        return fReader->ReadRecordAt( anIndex );
+    }
+
+    uint64_t MonarchCursor::GetRecordIndex() const
+    {
+        return fIndex;
+    }
+
+    void MonarchCursor::SetRecordIndex( uint64_t anIndex )
+    {
+        fIndex = anIndex;
+        return;
+    }
+
+    const MonarchRecordBytes* MonarchCursor::GetRecordInterleaved() const
+    {
+        return fReader->GetRecordInterleaved();
+    }
+    const MonarchRecordBytes* MonarchCursor::GetRecordSeparateOne() const
+    {
+        return fReader->GetRecordSeparateOne();
+    }
+    const MonarchRecordBytes* MonarchCursor::GetRecordSeparateTwo() const
+    {
+        return fReader->GetRecordSeparateTwo();
+    }
+
+}
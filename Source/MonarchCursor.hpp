@@ -0,0 +1,61 @@
+#ifndef MONARCHCURSOR_HPP_
+#define MONARCHCURSOR_HPP_
+
+#include "Monarch.hpp"
+
+namespace monarch
+{
+
+    //reads the records of a monarch that has read its header, with a position and record buffers of its own.
+    //the cursor shares the monarch's backend, header and footer, and reads with positional reads (see MonarchIO::ReadAt),
+    //so several cursors on one monarch can be used on different threads at once, each by one thread,
+    //for example to work through disjoint ranges of records in parallel.
+    //the monarch must not be read with ReadRecord while cursors are in use, and must outlive its cursors.
+    class MonarchCursor
+    {
+        public:
+            //an exception is thrown if the header of aMonarch has not been read.
+            MonarchCursor( const Monarch* aMonarch );
+            ~MonarchCursor();
+
+            //get the pointer to the header.
+            const MonarchHeader* GetHeader() const;
+
+            //set the interface type and the channel mask of this cursor (see Monarch); they start out as the monarch's.
+            void SetInterface( InterfaceModeType aMode );
+            void SetChannelMask( ChannelMaskType aMask );
+
+            //read the record anOffset records after the position, which then moves past it; false at the end of the file.
+            bool ReadRecord( int anOffset = 0 );
+
+            //read the record with index anIndex without moving the position; false if there is no such record.
+            bool ReadRecordAt( uint64_t anIndex );
+
+            //index of the record the next ReadRecord reads, counting from 0
+            uint64_t GetRecordIndex() const;
+            void SetRecordIndex( uint64_t anIndex );
+
+            //get the pointers to the current records; call them again after every read.
+            const MonarchRecordBytes* GetRecordInterleaved() const;
+            const MonarchRecordBytes* GetRecordSeparateOne() const;
+            const MonarchRecordBytes* GetRecordSeparateTwo() const;
+
+            //get a view of channel aChannel of the current record (see Monarch::GetChannel).
+            template< typename XType >
+            MonarchChannelView< XType > GetChannel( unsigned aChannel ) const;
+
+        private:
+            //the monarch the records are read through, sharing the backend of the one the cursor was made from
+            const Monarch* fReader;
+            uint64_t fIndex;
+    };
+
+    template< typename XType >
+    inline MonarchChannelView< XType > MonarchCursor::GetChannel( unsigned aChannel ) const
+    {
+        return fReader->GetChannel< XType >( aChannel );
+    }
+
+}
+
+#endif
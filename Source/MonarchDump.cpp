@@ -6,6 +6,9 @@
 #include <fstream>
 using std::ofstream;
 
+#include <vector>
+using std::vector;
+
 using namespace monarch;
 
 MLOGGER( mlog, "MonarchDump" );
@@ -48,11 +51,16 @@ int main( const int argc, const char** argv )
         }
 
         const unsigned tDataTypeSize = tReadHeader->GetDataTypeSize();
+        const unsigned tRecordSize = tReadHeader->GetRecordSize();
         const MonarchRecordBytes* tReadRecord = tReadTest->GetRecordSeparateOne();
-        const MonarchRecordDataInterface< uint64_t > tData( tReadRecord->fData, tDataTypeSize );
+        MonarchRecordDataInterface< uint64_t > tData( tReadRecord->fData, tDataTypeSize );
+        vector< uint64_t > tSamples( tRecordSize );
         unsigned int tRecordsPerChannel = 0;
         while( tReadTest->ReadRecord() != false )
         {
+            tReadRecord = tReadTest->GetRecordSeparateOne();
+            tData.SetData( tReadRecord->fData );
+            tData.CopyTo( &tSamples[ 0 ], tRecordSize );
             tRecordCount++;
             tRecordsPerChannel++;
             if( tReadRecord->fAcquisitionId == tAcquisitionCount )
@@ -60,9 +68,9 @@ int main( const int argc, const char** argv )
                 tAcquisitionCount = tAcquisitionCount + 1;
                 tOutputOne << "\n\n";
             }
-            for( unsigned int tIndex = 0; tIndex < tReadHeader->GetRecordSize(); tIndex++ )
+            for( unsigned int tIndex = 0; tIndex < tRecordSize; tIndex++ )
             {
-                tOutputOne << tIndex << " " << tData.at( tIndex ) << "\n";
+                tOutputOne << tIndex << " " << tSamples[ tIndex ] << "\n";
             }
             if (nRecords != 0 && tRecordsPerChannel >= nRecords)
                 break;
@@ -90,13 +98,22 @@ int main( const int argc, const char** argv )
         }
 
         const unsigned tDataTypeSize = tReadHeader->GetDataTypeSize();
+        const unsigned tRecordSize = tReadHeader->GetRecordSize();
         const MonarchRecordBytes* tReadRecordOne = tReadTest->GetRecordSeparateOne();
-        const MonarchRecordDataInterface< uint64_t > tDataOne( tReadRecordOne->fData, tDataTypeSize );
+        MonarchRecordDataInterface< uint64_t > tDataOne( tReadRecordOne->fData, tDataTypeSize );
         const MonarchRecordBytes* tReadRecordTwo = tReadTest->GetRecordSeparateTwo();
-        const MonarchRecordDataInterface< uint64_t > tDataTwo( tReadRecordTwo->fData , tDataTypeSize);
+        MonarchRecordDataInterface< uint64_t > tDataTwo( tReadRecordTwo->fData , tDataTypeSize);
+        vector< uint64_t > tSamplesOne( tRecordSize );
+        vector< uint64_t > tSamplesTwo( tRecordSize );
         unsigned int tRecordsPerChannel = 0;
         while( tReadTest->ReadRecord() != false )
         {
+            tReadRecordOne = tReadTest->GetRecordSeparateOne();
+            tReadRecordTwo = tReadTest->GetRecordSeparateTwo();
+            tDataOne.SetData( tReadRecordOne->fData );
+            tDataTwo.SetData( tReadRecordTwo->fData );
+            tDataOne.CopyTo( &tSamplesOne[ 0 ], tRecordSize );
+            tDataTwo.CopyTo( &tSamplesTwo[ 0 ], tRecordSize );
             tRecordCount = tRecordCount + 1;
             tRecordsPerChannel++;
             if( tReadRecordOne->fAcquisitionId == tAcquisitionCount )
@@ -105,10 +122,10 @@ int main( const int argc, const char** argv )
                 tOutputOne << "\n\n";
                 tOutputTwo << "\n\n";
             }
-            for( unsigned int tIndex = 0; tIndex < tReadHeader->GetRecordSize(); tIndex++ )
+            for( unsigned int tIndex = 0; tIndex < tRecordSize; tIndex++ )
             {
-                tOutputOne << tIndex << " " << tDataOne.at( tIndex ) << "\n";
-                tOutputTwo << tIndex << " " << tDataTwo.at( tIndex ) << "\n";
+                tOutputOne << tIndex << " " << tSamplesOne[ tIndex ] << "\n";
+                tOutputTwo << tIndex << " " << tSamplesTwo[ tIndex ] << "\n";
             }
             if (nRecords != 0 && tRecordsPerChannel >= nRecords)
                 break;
@@ -19,7 +19,8 @@ namespace monarch
 
     const char* MonarchException::what() const throw ()
         {
-        return fStream.str().c_str();
+        fMessage = fStream.str();
+        return fMessage.c_str();
         }
 
 }
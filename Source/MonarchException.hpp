@@ -6,6 +6,8 @@ using std::exception;
 
 #include <sstream>
 using std::stringstream;
+#include <string>
+using std::string;
 
 namespace monarch
 {
@@ -30,6 +32,8 @@ namespace monarch
 
                 private:
             stringstream fStream;
+            //what() hands out the message from here, so it outlives the call
+            mutable string fMessage;
             };
 
 }
@@ -0,0 +1,221 @@
+#include "MonarchFooter.hpp"
+#include "MonarchFooter.pb.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace monarch
+{
+
+    const char MonarchFooter::sFooterMagic[ 8 ] = { 'M', 'O', 'N', 'A', 'R', 'C', 'H', 'F' };
+
+    MonarchFooter::MonarchFooter() :
+            fProtobufFooter( new Protobuf::MonarchFooter() )
+    {
+        fProtobufFooter->set_nrecords( 0 );
+        fProtobufFooter->set_recordnbytes( 0 );
+    }
+    MonarchFooter::~MonarchFooter()
+    {
+        delete fProtobufFooter;
+    }
+
+    bool MonarchFooter::MarshalToIO( MonarchIO* anIO ) const
+    {
+        uint64_t tNBytes = fProtobufFooter->ByteSizeLong();
+        std::vector< char > tBuffer( tNBytes + 1 );
+        if( fProtobufFooter->SerializeToArray( &tBuffer[ 0 ], tNBytes ) == false )
+        {
+            return false;
+        }
+        if( anIO->Write( &tBuffer[ 0 ], tNBytes ) == false )
+        {
+            return false;
+        }
+        if( anIO->Write( &tNBytes ) == false )
+        {
+            return false;
+        }
+        return anIO->Write( sFooterMagic, sizeof(sFooterMagic) );
+    }
+
+    bool MonarchFooter::DemarshalFromFile( const string& aFilename )
+    {
+        FILE* tFile = fopen( aFilename.c_str(), "rb" );
+        if( tFile == NULL )
+        {
+            return false;
+        }
+
+        bool tFound = false;
+        uint64_t tNBytes = 0;
+        char tMagic[ sizeof(sFooterMagic) ];
+        if( fseeko( tFile, -(off_t) (sizeof(tNBytes) + sizeof(tMagic)), SEEK_END ) == 0 && fread( &tNBytes, sizeof(tNBytes), 1, tFile ) == 1 && fread( tMagic, sizeof(tMagic), 1, tFile ) == 1 && memcmp( tMagic, sFooterMagic, sizeof(tMagic) ) == 0 )
+        {
+            off_t tEnd = ftello( tFile );
+            if( tNBytes + sizeof(tNBytes) + sizeof(tMagic) <= (uint64_t) tEnd && fseeko( tFile, -(off_t) (tNBytes + sizeof(tNBytes) + sizeof(tMagic)), SEEK_END ) == 0 )
+            {
+                std::vector< char > tBuffer( tNBytes + 1 );
+                tFound = fread( &tBuffer[ 0 ], 1, tNBytes, tFile ) == tNBytes && fProtobufFooter->ParseFromArray( &tBuffer[ 0 ], tNBytes ) == true;
+            }
+        }
+        fclose( tFile );
+        return tFound;
+    }
+
+    void MonarchFooter::AddBlock( uint64_t anOffset, unsigned aNRecords, RecordIdType aFirstRecordId, TimeType aFirstTime, TimeType aLastTime, AcquisitionIdType aFirstAcquisitionId, AcquisitionIdType aLastAcquisitionId )
+    {
+        Protobuf::MonarchFooter_Block* tBlock = fProtobufFooter->add_blocks();
+        tBlock->set_offset( anOffset );
+        tBlock->set_nrecords( aNRecords );
+        tBlock->set_firstrecordid( aFirstRecordId );
+        tBlock->set_firsttime( aFirstTime );
+        tBlock->set_lasttime( aLastTime );
+        tBlock->set_firstacquisitionid( aFirstAcquisitionId );
+        tBlock->set_lastacquisitionid( aLastAcquisitionId );
+        return;
+    }
+
+    unsigned MonarchFooter::GetNBlocks() const
+    {
+        return fProtobufFooter->blocks_size();
+    }
+    uint64_t MonarchFooter::GetBlockOffset( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).offset();
+    }
+    unsigned MonarchFooter::GetBlockNRecords( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).nrecords();
+    }
+    RecordIdType MonarchFooter::GetBlockFirstRecordId( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).firstrecordid();
+    }
+    TimeType MonarchFooter::GetBlockFirstTime( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).firsttime();
+    }
+    TimeType MonarchFooter::GetBlockLastTime( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).lasttime();
+    }
+    AcquisitionIdType MonarchFooter::GetBlockFirstAcquisitionId( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).firstacquisitionid();
+    }
+    AcquisitionIdType MonarchFooter::GetBlockLastAcquisitionId( unsigned aBlock ) const
+    {
+        return fProtobufFooter->blocks( aBlock ).lastacquisitionid();
+    }
+
+    void MonarchFooter::AddRecordsNBytes( uint64_t aNBytes )
+    {
+        fProtobufFooter->set_recordsnbytes( fProtobufFooter->recordsnbytes() + aNBytes );
+        return;
+    }
+
+    void MonarchFooter::AddRecord( const MonarchRecordBytes* aRecord )
+    {
+        if( fProtobufFooter->nrecords() == 0 )
+        {
+            fProtobufFooter->set_firstrecordid( aRecord->fRecordId );
+            fProtobufFooter->set_firsttime( aRecord->fTime );
+            fProtobufFooter->set_firstacquisitionid( aRecord->fAcquisitionId );
+            fProtobufFooter->set_nacquisitions( 1 );
+        }
+        else if( aRecord->fAcquisitionId != fProtobufFooter->lastacquisitionid() )
+        {
+            fProtobufFooter->set_nacquisitions( fProtobufFooter->nacquisitions() + 1 );
+        }
+        fProtobufFooter->set_lastrecordid( aRecord->fRecordId );
+        fProtobufFooter->set_lasttime( aRecord->fTime );
+        fProtobufFooter->set_lastacquisitionid( aRecord->fAcquisitionId );
+        fProtobufFooter->set_nrecords( fProtobufFooter->nrecords() + 1 );
+        return;
+    }
+
+    void MonarchFooter::SetNRecords( uint64_t aNRecords )
+    {
+        fProtobufFooter->set_nrecords( aNRecords );
+        return;
+    }
+    uint64_t MonarchFooter::GetNRecords() const
+    {
+        return fProtobufFooter->nrecords();
+    }
+
+    uint64_t MonarchFooter::GetNAcquisitions() const
+    {
+        return fProtobufFooter->nacquisitions();
+    }
+
+    RecordIdType MonarchFooter::GetFirstRecordId() const
+    {
+        return fProtobufFooter->firstrecordid();
+    }
+    RecordIdType MonarchFooter::GetLastRecordId() const
+    {
+        return fProtobufFooter->lastrecordid();
+    }
+    TimeType MonarchFooter::GetFirstTime() const
+    {
+        return fProtobufFooter->firsttime();
+    }
+    TimeType MonarchFooter::GetLastTime() const
+    {
+        return fProtobufFooter->lasttime();
+    }
+    AcquisitionIdType MonarchFooter::GetFirstAcquisitionId() const
+    {
+        return fProtobufFooter->firstacquisitionid();
+    }
+    AcquisitionIdType MonarchFooter::GetLastAcquisitionId() const
+    {
+        return fProtobufFooter->lastacquisitionid();
+    }
+
+    uint64_t MonarchFooter::GetRecordsNBytes() const
+    {
+        return fProtobufFooter->recordsnbytes();
+    }
+
+    void MonarchFooter::SetStoredNBytes( uint64_t aNBytes )
+    {
+        fProtobufFooter->set_storednbytes( aNBytes );
+        return;
+    }
+    uint64_t MonarchFooter::GetStoredNBytes() const
+    {
+        return fProtobufFooter->storednbytes();
+    }
+
+    void MonarchFooter::SetRecordNBytes( uint64_t aNBytes )
+    {
+        fProtobufFooter->set_recordnbytes( aNBytes );
+        return;
+    }
+    uint64_t MonarchFooter::GetRecordNBytes() const
+    {
+        return fProtobufFooter->recordnbytes();
+    }
+
+}
+
+std::ostream& operator<<( std::ostream& out, const monarch::MonarchFooter& ftr )
+{
+    out << "Monarch Footer Content: " << "\n";
+    out << "\tRecords: " << ftr.GetNRecords() << "\n";
+    out << "\tAcquisitions: " << ftr.GetNAcquisitions() << "\n";
+    if( ftr.GetNRecords() > 0 )
+    {
+        out << "\tRecord Ids: " << ftr.GetFirstRecordId() << " to " << ftr.GetLastRecordId() << "\n";
+        out << "\tTimes: " << ftr.GetFirstTime() << " to " << ftr.GetLastTime() << " ns\n";
+        out << "\tAcquisition Ids: " << ftr.GetFirstAcquisitionId() << " to " << ftr.GetLastAcquisitionId() << "\n";
+    }
+    out << "\tRecord Size: " << ftr.GetRecordNBytes() << " bytes\n";
+    out << "\tRecord Bytes: " << ftr.GetRecordsNBytes() << " bytes\n";
+    out << "\tStored Bytes: " << ftr.GetStoredNBytes() << " bytes\n";
+    out << "\tBlocks: " << ftr.GetNBlocks() << "\n";
+    return out;
+}
@@ -0,0 +1,94 @@
+#ifndef MONARCHFOOTER_HPP_
+#define MONARCHFOOTER_HPP_
+
+#include "MonarchIO.hpp"
+#include "MonarchRecord.hpp"
+#include "MonarchTypes.hpp"
+
+#include <string>
+using std::string;
+
+namespace Protobuf
+{
+    class MonarchFooter;
+}
+
+namespace monarch
+{
+
+    //the footer that follows the records of a file once it is closed: a summary of the run,
+    //and the block index of a file whose records are stored in blocks.
+    //the file ends with the marshalled footer, its size as a uint64_t and the 8 bytes of sFooterMagic,
+    //so a reader can find the footer from the end of the file without looking at the records.
+    class MonarchFooter
+    {
+        private:
+            mutable Protobuf::MonarchFooter* fProtobufFooter;
+
+        public:
+            MonarchFooter();
+            ~MonarchFooter();
+
+            static const char sFooterMagic[ 8 ];
+
+            //marshal the footer and the trailer behind it to the current position of anIO
+            bool MarshalToIO( MonarchIO* anIO ) const;
+
+            //find the footer at the end of the file aFilename and demarshal it.
+            //returns false if the file does not end with a footer, for example because it was not closed.
+            bool DemarshalFromFile( const string& aFilename );
+
+            //access methods
+
+            //append a block
+            void AddBlock( uint64_t anOffset, unsigned aNRecords, RecordIdType aFirstRecordId, TimeType aFirstTime, TimeType aLastTime, AcquisitionIdType aFirstAcquisitionId, AcquisitionIdType aLastAcquisitionId );
+
+            unsigned GetNBlocks() const;
+            // Offset of the block from the first byte after the header
+            uint64_t GetBlockOffset( unsigned aBlock ) const;
+            unsigned GetBlockNRecords( unsigned aBlock ) const;
+            RecordIdType GetBlockFirstRecordId( unsigned aBlock ) const;
+            TimeType GetBlockFirstTime( unsigned aBlock ) const;
+            TimeType GetBlockLastTime( unsigned aBlock ) const;
+            AcquisitionIdType GetBlockFirstAcquisitionId( unsigned aBlock ) const;
+            AcquisitionIdType GetBlockLastAcquisitionId( unsigned aBlock ) const;
+
+            //add a written record to the summary; it is counted once, whatever the number of channels it is stored as.
+            void AddRecord( const MonarchRecordBytes* aRecord );
+
+            //add aNBytes bytes of records in the file to the summary
+            void AddRecordsNBytes( uint64_t aNBytes );
+
+            // Number of records (of every channel) in the file
+            void SetNRecords( uint64_t aNRecords );
+            uint64_t GetNRecords() const;
+
+            // Number of acquisitions the records come from
+            uint64_t GetNAcquisitions() const;
+
+            // First and last records of the file
+            RecordIdType GetFirstRecordId() const;
+            RecordIdType GetLastRecordId() const;
+            TimeType GetFirstTime() const;
+            TimeType GetLastTime() const;
+            AcquisitionIdType GetFirstAcquisitionId() const;
+            AcquisitionIdType GetLastAcquisitionId() const;
+
+            // Bytes of records written, before compression
+            uint64_t GetRecordsNBytes() const;
+
+            // Bytes the records take up in the file, after compression and including the block frames
+            void SetStoredNBytes( uint64_t aNBytes );
+            uint64_t GetStoredNBytes() const;
+
+            // Bytes the records of every channel with one record id take up before compression
+            void SetRecordNBytes( uint64_t aNBytes );
+            uint64_t GetRecordNBytes() const;
+    };
+
+}
+
+// Pretty printing method
+std::ostream& operator<<( std::ostream& out, const monarch::MonarchFooter& ftr );
+
+#endif
@@ -42,6 +42,12 @@ namespace monarch
         return fProtobufHeader->ParseFromIstream( aStream );
     }
 
+    void MonarchHeader::CopyFrom( const MonarchHeader& aHeader )
+    {
+        fProtobufHeader->CopyFrom( *aHeader.fProtobufHeader );
+        return;
+    }
+
     void MonarchHeader::SetFilename( const string& aFilename )
     {
         fProtobufHeader->set_filename( aFilename );
@@ -273,6 +279,66 @@ TimeType MonarchHeader::GetRecordTime0() const
     {
         return fProtobufHeader->voltagerange();
     }
+
+    void MonarchHeader::SetBitPacked( bool aFlag )
+    {
+        fProtobufHeader->set_bitpacked( aFlag );
+        return;
+    }
+    bool MonarchHeader::GetBitPacked() const
+    {
+        return fProtobufHeader->bitpacked();
+    }
+
+    void MonarchHeader::SetCompression( CompressionType aCompression )
+    {
+        fProtobufHeader->set_compression( (Protobuf::MonarchHeader_Compression) aCompression );
+        return;
+    }
+    CompressionType MonarchHeader::GetCompression() const
+    {
+        return fProtobufHeader->compression();
+    }
+
+    void MonarchHeader::SetBlockSize( unsigned aSize )
+    {
+        fProtobufHeader->set_blocksize( aSize );
+        return;
+    }
+    unsigned MonarchHeader::GetBlockSize() const
+    {
+        return fProtobufHeader->blocksize();
+    }
+
+    void MonarchHeader::SetBlockIndex( bool aFlag )
+    {
+        fProtobufHeader->set_blockindex( aFlag );
+        return;
+    }
+    bool MonarchHeader::GetBlockIndex() const
+    {
+        return fProtobufHeader->blockindex();
+    }
+
+    void MonarchHeader::SetChecksums( bool aFlag )
+    {
+        fProtobufHeader->set_checksums( aFlag );
+        return;
+    }
+    bool MonarchHeader::GetChecksums() const
+    {
+        return fProtobufHeader->checksums();
+    }
+
+    void MonarchHeader::SetAlignment( unsigned anAlignment )
+    {
+        fProtobufHeader->set_alignment( anAlignment );
+        return;
+    }
+    unsigned MonarchHeader::GetAlignment() const
+    {
+        return fProtobufHeader->alignment();
+    }
 }
 
 std::ostream& operator<<( std::ostream& out, const monarch::MonarchHeader& hdr )
@@ -292,5 +358,11 @@ std::ostream& operator<<( std::ostream& out, const monarch::MonarchHeader& hdr )
     out << "\tBit Depth: " << hdr.GetBitDepth() << " bits\n";
     out << "\tVoltage Min: " << hdr.GetVoltageMin() << " V\n";
     out << "\tVoltage Range: " << hdr.GetVoltageRange() << " V\n";
+    out << "\tBit Packed: " << (hdr.GetBitPacked() ? "yes" : "no") << "\n";
+    out << "\tCompression: " << hdr.GetCompression() << "\n";
+    out << "\tBlock Size: " << hdr.GetBlockSize() << " records\n";
+    out << "\tBlock Index: " << (hdr.GetBlockIndex() ? "yes" : "no") << "\n";
+    out << "\tChecksums: " << (hdr.GetChecksums() ? "yes" : "no") << "\n";
+    out << "\tAlignment: " << hdr.GetAlignment() << " bytes\n";
     return out;
 }
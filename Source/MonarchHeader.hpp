@@ -34,6 +34,9 @@ namespace monarch
             bool DemarshalFromArray( void* anArray, int aSize ) const;
             bool DemarshalFromStream( std::istream* aStream ) const;
 
+            //copy every field of aHeader into this header
+            void CopyFrom( const MonarchHeader& aHeader );
+
             //access methods
 
             // Required in protobuf header
@@ -87,6 +90,30 @@ namespace monarch
             void SetVoltageRange( double aVoltage );
             double GetVoltageRange() const;
 
+            // Store the samples at exactly the bit depth instead of in data-type-size containers
+            void SetBitPacked( bool aFlag );
+            bool GetBitPacked() const;
+
+            // Compress the records in blocks with the given codec
+            void SetCompression( CompressionType aCompression );
+            CompressionType GetCompression() const;
+
+            // Records per block; 0 lets Monarch choose
+            void SetBlockSize( unsigned aSize );
+            unsigned GetBlockSize() const;
+
+            // Group the records into blocks and write an index of the blocks in a footer when the file is closed
+            void SetBlockIndex( bool aFlag );
+            bool GetBlockIndex() const;
+
+            // Group the records into blocks and store a CRC32C checksum with every block
+            void SetChecksums( bool aFlag );
+            bool GetChecksums() const;
+
+            // Pad the header and every record to a multiple of this many bytes (a power of two); 0 for no padding
+            void SetAlignment( unsigned anAlignment );
+            unsigned GetAlignment() const;
+
     };
 
 }
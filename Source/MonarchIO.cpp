@@ -1,64 +1,140 @@
 #include "MonarchIO.hpp"
 
+#include "MonarchIOBuffered.hpp"
+#include "MonarchIODirect.hpp"
+#include "MonarchIOMapped.hpp"
+#include "MonarchIOPositional.hpp"
+#include "MonarchIOReadAhead.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace monarch
 {
 
+    // files at least this big are read with positional I/O when sIOAuto is requested;
+    // below it the stdio buffer is as good and the file is likely to be cached anyway
+    static const off_t sAutoPositionalSize = 64 * 1024 * 1024;
+
     MonarchIO::MonarchIO( AccessModeType aMode ) :
-            fFile( NULL ),
-            fMode( aMode )
+            fMode( aMode ),
+            fReservedNBytes( 0 )
     {
 
     }
     MonarchIO::~MonarchIO()
     {
-        if( fFile )
-        {
-            fclose( fFile );
-        }
     }
 
-    bool MonarchIO::Open( const string& aFilename )
+    MonarchIO* MonarchIO::Create( AccessModeType aMode, IOModeType anIOMode, const string& aFilename )
     {
-        if( fMode == sAccessRead )
-        {
-            fFile = fopen( aFilename.c_str(), "rb" );
-        }
-        else if( fMode == sAccessWrite )
+        if( anIOMode == sIOAuto )
         {
-            fFile = fopen( aFilename.c_str(), "wb" );
+            anIOMode = sIOBuffered;
+            if( aMode == sAccessRead )
+            {
+                struct stat tStat;
+                if( stat( aFilename.c_str(), &tStat ) == 0 && tStat.st_size >= sAutoPositionalSize )
+                {
+                    anIOMode = sIOPositional;
+                }
+            }
         }
 
-        if( fFile == NULL )
+        switch( anIOMode )
         {
-            return false;
+            case sIOBuffered:
+                return new MonarchIOBuffered( aMode );
+            case sIOMapped:
+                if( aMode != sAccessRead ) return NULL;
+                return new MonarchIOMapped( aMode );
+            case sIOPositional:
+                return new MonarchIOPositional( aMode );
+            case sIODirect:
+                return new MonarchIODirect( aMode );
+            case sIOReadAhead:
+                if( aMode != sAccessRead ) return NULL;
+                return new MonarchIOReadAhead( aMode );
+            default:
+                return NULL;
         }
-        return true;
     }
-    bool MonarchIO::Done()
+
+    const byte_type* MonarchIO::Map( size_t )
+    {
+        return NULL;
+    }
+
+    bool MonarchIO::IsMapped() const
+    {
+        return false;
+    }
+
+    bool MonarchIO::ReadAt( byte_type*, size_t, uint64_t )
+    {
+        return false;
+    }
+
+    const byte_type* MonarchIO::MapAt( size_t, uint64_t )
+    {
+        return NULL;
+    }
+
+    bool MonarchIO::ReadFully( int aDescriptor, byte_type* anArray, size_t aCount, uint64_t anOffset )
     {
-        if( fFile != NULL )
+        while( aCount > 0 )
         {
-            if( feof( fFile ) == 0 )
+            ssize_t tRead = pread( aDescriptor, anArray, aCount, (off_t) anOffset );
+            if( tRead < 0 )
             {
+                if( errno == EINTR ) continue;
                 return false;
             }
-            return true;
+            if( tRead == 0 )
+            {
+                return false;
+            }
+            anArray += tRead;
+            aCount -= tRead;
+            anOffset += tRead;
         }
+        return true;
+    }
+
+    void MonarchIO::SetRecordNBytes( size_t )
+    {
+        return;
+    }
+
+    bool MonarchIO::Preallocate( uint64_t )
+    {
         return false;
     }
-    bool MonarchIO::Close()
+
+    bool MonarchIO::Reserve( int aDescriptor, uint64_t aNBytes )
     {
-        if( fFile )
+#ifdef FALLOC_FL_KEEP_SIZE
+        // the size of the file is left alone, so readers of a file that is still being written see only the records
+        if( fallocate( aDescriptor, FALLOC_FL_KEEP_SIZE, 0, aNBytes ) == 0 )
         {
-            if( fclose( fFile ) != 0 )
-            {
-                fFile = NULL;
-                return false;
-            }
-            fFile = NULL;
+            fReservedNBytes = aNBytes;
             return true;
         }
+#endif
         return false;
     }
 
+    bool MonarchIO::Release( int aDescriptor, uint64_t anEnd )
+    {
+        if( fReservedNBytes <= anEnd )
+        {
+            return true;
+        }
+        fReservedNBytes = 0;
+        // truncating a file to its own size frees the blocks reserved past its end
+        return ftruncate( aDescriptor, anEnd ) == 0;
+    }
+
 }
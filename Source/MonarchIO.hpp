@@ -11,88 +11,114 @@ using std::cout;
 using std::endl;
 
 #include <cstdio>
+#include <cstring>
 
 namespace monarch
 {
 
+    // Abstract file backend; see MonarchIOBuffered, MonarchIOPositional,
+    // MonarchIOMapped, MonarchIODirect and MonarchIOReadAhead for the implementations.
     class MonarchIO
     {
-            FILE *fFile;
+        protected:
             AccessModeType fMode;
+
+            // Bytes reserved with Reserve, 0 if none
+            uint64_t fReservedNBytes;
+
+            // Reserve the first aNBytes bytes of the file behind aDescriptor without changing its size
+            bool Reserve( int aDescriptor, uint64_t aNBytes );
+            // Give back whatever was reserved past anEnd, the end of what was written
+            bool Release( int aDescriptor, uint64_t anEnd );
+
+            // Read aCount bytes at anOffset of the file behind aDescriptor with pread, however many calls it takes
+            static bool ReadFully( int aDescriptor, byte_type* anArray, size_t aCount, uint64_t anOffset );
+
         public:
             // Constructors and Destructors
             MonarchIO( AccessModeType aMode );
-            ~MonarchIO();
+            virtual ~MonarchIO();
+
+            // Create the backend for anIOMode; sIOAuto picks one from the size of aFilename.
+            // Returns NULL if the backend cannot be used with aMode.
+            static MonarchIO* Create( AccessModeType aMode, IOModeType anIOMode, const string& aFilename );
 
             // Open the file in whatever mode was given the constructor
-            bool Open( const string& aFilename );
+            virtual bool Open( const string& aFilename ) = 0;
 
             // Write nbytes of data from the byte array wbuf to the
             // current position of the file pointer.
-            bool Write( byte_type* anArray, size_t aCount );
+            virtual bool Write( const byte_type* anArray, size_t aCount ) = 0;
             template< class XType >
             bool Write( XType* aDatum );
             template< class XType >
             bool Write( XType* aDatum, size_t aCount );
 
             // Seek by offset aCount bytes
-            bool Seek( long int aCount );
+            virtual bool Seek( long int aCount ) = 0;
 
             // Read aCout bytes of data from the file pointer and store
             // the result in the byte array anArray.
-            bool Read( byte_type* anArray, size_t aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount ) = 0;
             template< class XType >
             bool Read( XType* aDatum );
             template< class XType >
             bool Read( XType* aDatum, size_t aCount );
 
+            // Return a pointer to the next aCount bytes of the file
+            // and advance past them; returns NULL if fewer than aCount bytes remain
+            // or if the backend cannot hand out its memory.
+            virtual const byte_type* Map( size_t aCount );
+
+            // True if reads are served from a memory mapping of the file
+            virtual bool IsMapped() const;
+
+            // Read aCount bytes at anOffset into anArray without moving the position of Read and Seek.
+            // anOffset counts from the start of the file; a block stream counts in record bytes from its first record,
+            // as its Seek does. Returns false if the bytes are not all there or the backend cannot read at an offset.
+            // ReadAt and MapAt can be called from several threads at once, and alongside Read and Seek on one other thread.
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+
+            // Return a pointer to the aCount bytes at anOffset of a mapped file, without moving the position;
+            // returns NULL if they are not all there or the backend cannot hand out its memory.
+            virtual const byte_type* MapAt( size_t aCount, uint64_t anOffset );
+
+            // Tell the backend how many bytes each record occupies in the file,
+            // once the header has been read; the default ignores it.
+            virtual void SetRecordNBytes( size_t aNBytes );
+
+            // Reserve space for a file of aNBytes bytes that is about to be written, so the file system can lay it
+            // out in few extents; what is not written is given back on Close. Returns false if the backend
+            // or the file system cannot reserve space, which only costs the layout.
+            virtual bool Preallocate( uint64_t aNBytes );
+
             // File is at end
-            bool Done();
+            virtual bool Done() = 0;
 
             // Close the file handle owned by this IO object
-            bool Close();
+            virtual bool Close() = 0;
     };
 
-    inline bool MonarchIO::Write( byte_type* anArray, size_t aCount )
-    {
-        size_t written = fwrite( anArray, sizeof(byte_type), aCount, fFile );
-        return (written == sizeof(byte_type) * aCount);
-    }
     template< class XType >
     inline bool MonarchIO::Write( XType* aDatum )
     {
-            size_t written = fwrite( aDatum, sizeof(XType), 1, fFile );
-            return (written == 1);
+            return Write( reinterpret_cast< const byte_type* >( aDatum ), sizeof(XType) );
     }
     template< class XType >
     inline bool MonarchIO::Write( XType* aDatum, size_t aCount )
     {
-            size_t written = fwrite( aDatum, sizeof(XType), aCount, fFile );
-            return (written == aCount);
+            return Write( reinterpret_cast< const byte_type* >( aDatum ), sizeof(XType) * aCount );
     }
 
-    inline bool MonarchIO::Seek( long int aCount )
-    {
-        size_t success = fseek( fFile, aCount, SEEK_CUR );
-        return( success == 0 );
-    }
-
-    inline bool MonarchIO::Read( byte_type* anArray, size_t aCount )
-    {
-        size_t read = fread( anArray, sizeof(byte_type), aCount, fFile );
-        return (read == sizeof(byte_type) * aCount);
-    }
     template< class XType >
     inline bool MonarchIO::Read( XType* aDatum )
     {
-            size_t read = fread( aDatum, sizeof(XType), 1, fFile );
-            return (read == 1);
+            return Read( reinterpret_cast< byte_type* >( aDatum ), sizeof(XType) );
     }
     template< class XType >
     inline bool MonarchIO::Read( XType* aDatum, size_t aCount )
     {
-            size_t read = fread( aDatum, sizeof(XType), aCount, fFile );
-            return (read == aCount);
+            return Read( reinterpret_cast< byte_type* >( aDatum ), sizeof(XType) * aCount );
     }
 
 }
@@ -0,0 +1,121 @@
+#include "MonarchIOBounded.hpp"
+
+namespace monarch
+{
+
+    MonarchIOBounded::MonarchIOBounded( MonarchIO* anIO, uint64_t aStart, uint64_t aNBytes ) :
+            MonarchIO( sAccessRead ),
+            fIO( anIO ),
+            fStart( aStart ),
+            fEnd( aNBytes ),
+            fPosition( 0 ),
+            fDone( false )
+    {
+    }
+    MonarchIOBounded::~MonarchIOBounded()
+    {
+        delete fIO;
+    }
+
+    bool MonarchIOBounded::Open( const string& )
+    {
+        // the view is put on top of a backend that is already open
+        return false;
+    }
+
+    bool MonarchIOBounded::Write( const byte_type*, size_t )
+    {
+        return false;
+    }
+
+    bool MonarchIOBounded::Fits( size_t aCount )
+    {
+        if( fPosition > fEnd || aCount > fEnd - fPosition )
+        {
+            fDone = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool MonarchIOBounded::Seek( long int aCount )
+    {
+        if( aCount < 0 && (uint64_t) (-aCount) > fPosition )
+        {
+            return false;
+        }
+        // as with the other backends, seeking past the end succeeds and the next read fails
+        if( fIO->Seek( aCount ) == false )
+        {
+            return false;
+        }
+        fPosition += aCount;
+        fDone = false;
+        return true;
+    }
+
+    bool MonarchIOBounded::Read( byte_type* anArray, size_t aCount )
+    {
+        if( Fits( aCount ) == false || fIO->Read( anArray, aCount ) == false )
+        {
+            return false;
+        }
+        fPosition += aCount;
+        return true;
+    }
+
+    const byte_type* MonarchIOBounded::Map( size_t aCount )
+    {
+        if( Fits( aCount ) == false )
+        {
+            return NULL;
+        }
+        const byte_type* tPointer = fIO->Map( aCount );
+        if( tPointer != NULL )
+        {
+            fPosition += aCount;
+        }
+        return tPointer;
+    }
+
+    bool MonarchIOBounded::Within( size_t aCount, uint64_t anOffset ) const
+    {
+        return anOffset >= fStart && anOffset - fStart <= fEnd && aCount <= fEnd - (anOffset - fStart);
+    }
+
+    bool MonarchIOBounded::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        return Within( aCount, anOffset ) == true && fIO->ReadAt( anArray, aCount, anOffset ) == true;
+    }
+
+    const byte_type* MonarchIOBounded::MapAt( size_t aCount, uint64_t anOffset )
+    {
+        if( Within( aCount, anOffset ) == false )
+        {
+            return NULL;
+        }
+        return fIO->MapAt( aCount, anOffset );
+    }
+
+    bool MonarchIOBounded::IsMapped() const
+    {
+        return fIO->IsMapped();
+    }
+
+    void MonarchIOBounded::SetRecordNBytes( size_t aNBytes )
+    {
+        fIO->SetRecordNBytes( aNBytes );
+        return;
+    }
+
+    bool MonarchIOBounded::Done()
+    {
+        return fDone == true || fIO->Done() == true;
+    }
+
+    bool MonarchIOBounded::Close()
+    {
+        return fIO->Close();
+    }
+
+}
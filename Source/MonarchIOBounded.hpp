@@ -0,0 +1,49 @@
+#ifndef MONARCHIOBOUNDED_HPP_
+#define MONARCHIOBOUNDED_HPP_
+
+#include "MonarchIO.hpp"
+
+namespace monarch
+{
+
+    // Reading view of the first aNBytes bytes after the current position of another backend,
+    // for the records of a file that are followed by a footer. Reads and maps that would go past
+    // the end fail and leave the view done, as the other backends do at the end of the file.
+    // aStart is the current position of anIO in the file; ReadAt and MapAt take offsets in the file
+    // like the other backends, and only reach the bytes of the view.
+    // The view takes over anIO.
+    class MonarchIOBounded :
+        public MonarchIO
+    {
+        public:
+            MonarchIOBounded( MonarchIO* anIO, uint64_t aStart, uint64_t aNBytes );
+            virtual ~MonarchIOBounded();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual const byte_type* Map( size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual const byte_type* MapAt( size_t aCount, uint64_t anOffset );
+            virtual bool IsMapped() const;
+            virtual void SetRecordNBytes( size_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+
+        private:
+            MonarchIO* fIO;
+            uint64_t fStart;
+            uint64_t fEnd;
+            uint64_t fPosition;
+            bool fDone;
+
+            // true if aCount more bytes are within the view
+            bool Fits( size_t aCount );
+            // true if the aCount bytes at anOffset of the file are within the view
+            bool Within( size_t aCount, uint64_t anOffset ) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "MonarchIOBuffered.hpp"
+
+namespace monarch
+{
+
+    MonarchIOBuffered::MonarchIOBuffered( AccessModeType aMode ) :
+            MonarchIO( aMode ),
+            fFile( NULL )
+    {
+    }
+    MonarchIOBuffered::~MonarchIOBuffered()
+    {
+        if( fFile )
+        {
+            fclose( fFile );
+        }
+    }
+
+    bool MonarchIOBuffered::Open( const string& aFilename )
+    {
+        if( fMode == sAccessRead )
+        {
+            fFile = fopen( aFilename.c_str(), "rb" );
+        }
+        else if( fMode == sAccessWrite )
+        {
+            fFile = fopen( aFilename.c_str(), "wb" );
+        }
+
+        if( fFile == NULL )
+        {
+            return false;
+        }
+        return true;
+    }
+    bool MonarchIOBuffered::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        // pread leaves the offset of the descriptor, and with it the stdio buffer, alone
+        if( fFile == NULL || fMode != sAccessRead )
+        {
+            return false;
+        }
+        return ReadFully( fileno( fFile ), anArray, aCount, anOffset );
+    }
+
+    bool MonarchIOBuffered::Done()
+    {
+        if( fFile != NULL )
+        {
+            if( feof( fFile ) == 0 )
+            {
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+    bool MonarchIOBuffered::Preallocate( uint64_t aNBytes )
+    {
+        if( fFile == NULL || fMode != sAccessWrite )
+        {
+            return false;
+        }
+        return Reserve( fileno( fFile ), aNBytes );
+    }
+
+    bool MonarchIOBuffered::Close()
+    {
+        if( fFile )
+        {
+            if( fReservedNBytes > 0 && fflush( fFile ) == 0 )
+            {
+                Release( fileno( fFile ), ftello( fFile ) );
+            }
+            if( fclose( fFile ) != 0 )
+            {
+                fFile = NULL;
+                return false;
+            }
+            fFile = NULL;
+            return true;
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,49 @@
+#ifndef MONARCHIOBUFFERED_HPP_
+#define MONARCHIOBUFFERED_HPP_
+
+#include "MonarchIO.hpp"
+
+namespace monarch
+{
+
+    // Buffered stdio backend (sIOBuffered)
+    class MonarchIOBuffered :
+        public MonarchIO
+    {
+            FILE *fFile;
+
+        public:
+            MonarchIOBuffered( AccessModeType aMode );
+            virtual ~MonarchIOBuffered();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual bool Preallocate( uint64_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+    };
+
+    inline bool MonarchIOBuffered::Write( const byte_type* anArray, size_t aCount )
+    {
+        size_t written = fwrite( anArray, sizeof(byte_type), aCount, fFile );
+        return (written == sizeof(byte_type) * aCount);
+    }
+
+    inline bool MonarchIOBuffered::Seek( long int aCount )
+    {
+        size_t success = fseek( fFile, aCount, SEEK_CUR );
+        return( success == 0 );
+    }
+
+    inline bool MonarchIOBuffered::Read( byte_type* anArray, size_t aCount )
+    {
+        size_t read = fread( anArray, sizeof(byte_type), aCount, fFile );
+        return (read == sizeof(byte_type) * aCount);
+    }
+
+}
+
+#endif
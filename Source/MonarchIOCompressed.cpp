@@ -0,0 +1,682 @@
+#include "MonarchIOCompressed.hpp"
+
+#include "MonarchChecksum.hpp"
+#include "MonarchCompression.hpp"
+#include "MonarchRecord.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace monarch
+{
+
+    MonarchIOCompressed::MonarchIOCompressed( MonarchIO* anIO, AccessModeType aMode, CompressionType aCompression, size_t anElementNBytes, size_t aRecordNBytes, size_t aBlockSize, uint64_t aStart ) :
+            MonarchIO( aMode ),
+            fIO( anIO ),
+            fCompression( aCompression ),
+            fElementNBytes( anElementNBytes ),
+            fRecordNBytes( aRecordNBytes ),
+            fBlockNBytes( aRecordNBytes * aBlockSize ),
+            fDone( false ),
+            fFooter( NULL ),
+            fTrailerNBytes( 0 ),
+            fBlocks(),
+            fOldest( 0 ),
+            fNPending( 0 ),
+            fTake( 0 ),
+            fFailed( false ),
+            fNWorkers( 0 ),
+            fStopping( false ),
+            fBuffer(),
+            fReadStored(),
+            fReadShuffled(),
+            fBufferNBytes( 0 ),
+            fBufferPosition( 0 ),
+            fBufferStart( 0 ),
+            fBlockOffsets(),
+            fBlockStarts(),
+            fStreamPosition( 0 ),
+            fHasAtKey( false ),
+            fStart( aStart )
+    {
+        pthread_mutex_init( &fMutex, NULL );
+        pthread_cond_init( &fQueued, NULL );
+        pthread_cond_init( &fCompressed, NULL );
+        pthread_mutex_init( &fBlocksMutex, NULL );
+
+        if( fMode != sAccessWrite )
+        {
+            fHasAtKey = pthread_key_create( &fAtKey, &MonarchIOCompressed::DeleteAtBlock ) == 0;
+            return;
+        }
+
+        // the caller fills and writes blocks while the other cores compress
+        long tNCores = sysconf( _SC_NPROCESSORS_ONLN );
+        unsigned tNWorkers = tNCores > 1 ? (unsigned) (tNCores - 1) : 0;
+        if( tNWorkers > sMaxWorkers )
+        {
+            tNWorkers = sMaxWorkers;
+        }
+
+        // one block for each worker, one being filled and one being written
+        fBlocks.resize( tNWorkers + 2 );
+        size_t tStoredNBytes = MonarchCompression::Bound( fCompression, fBlockNBytes );
+        for( unsigned tIndex = 0; tIndex < fBlocks.size(); ++tIndex )
+        {
+            Block& tBlock = fBlocks[ tIndex ];
+            tBlock.fRaw = new byte_type[ fBlockNBytes ];
+            tBlock.fRawNBytes = 0;
+            tBlock.fShuffled = fElementNBytes > 1 ? new byte_type[ fBlockNBytes ] : NULL;
+            tBlock.fStored = new byte_type[ tStoredNBytes ];
+            tBlock.fPayload = NULL;
+            tBlock.fState = Block::eFree;
+        }
+
+        for( ; fNWorkers < tNWorkers; ++fNWorkers )
+        {
+            if( pthread_create( &fWorkers[ fNWorkers ], NULL, &MonarchIOCompressed::Run, this ) != 0 )
+            {
+                // fewer workers only costs throughput
+                break;
+            }
+        }
+    }
+
+    MonarchIOCompressed::~MonarchIOCompressed()
+    {
+        pthread_mutex_lock( &fMutex );
+        fStopping = true;
+        pthread_cond_broadcast( &fQueued );
+        pthread_mutex_unlock( &fMutex );
+        for( unsigned tIndex = 0; tIndex < fNWorkers; ++tIndex )
+        {
+            pthread_join( fWorkers[ tIndex ], NULL );
+        }
+        fNWorkers = 0;
+
+        for( unsigned tIndex = 0; tIndex < fBlocks.size(); ++tIndex )
+        {
+            delete[] fBlocks[ tIndex ].fRaw;
+            delete[] fBlocks[ tIndex ].fShuffled;
+            delete[] fBlocks[ tIndex ].fStored;
+        }
+
+        if( fHasAtKey == true )
+        {
+            // the blocks of threads that are still running are not reached from here
+            DeleteAtBlock( pthread_getspecific( fAtKey ) );
+            pthread_key_delete( fAtKey );
+        }
+
+        pthread_mutex_destroy( &fBlocksMutex );
+        pthread_cond_destroy( &fCompressed );
+        pthread_cond_destroy( &fQueued );
+        pthread_mutex_destroy( &fMutex );
+
+        delete fIO;
+    }
+
+    bool MonarchIOCompressed::Open( const string& )
+    {
+        // the stream is put on top of a backend that is already open
+        return false;
+    }
+
+    void MonarchIOCompressed::SetRecordNBytes( size_t aNBytes )
+    {
+        fIO->SetRecordNBytes( aNBytes );
+        return;
+    }
+
+    bool MonarchIOCompressed::Preallocate( uint64_t aNBytes )
+    {
+        // the size of the records before compression is as much as the blocks can take up
+        return fIO->Preallocate( aNBytes );
+    }
+
+    void MonarchIOCompressed::SetFooter( MonarchFooter* aFooter )
+    {
+        fFooter = aFooter;
+        if( fMode != sAccessRead || fFooter->GetRecordNBytes() == 0 )
+        {
+            return;
+        }
+
+        fBlockOffsets.clear();
+        fBlockStarts.clear();
+        uint64_t tStart = 0;
+        for( unsigned tBlock = 0; tBlock < fFooter->GetNBlocks(); ++tBlock )
+        {
+            fBlockOffsets.push_back( fFooter->GetBlockOffset( tBlock ) );
+            fBlockStarts.push_back( tStart );
+            tStart += fFooter->GetBlockNRecords( tBlock ) * fFooter->GetRecordNBytes();
+        }
+        return;
+    }
+
+    void MonarchIOCompressed::SetChecksums( bool aFlag )
+    {
+        fTrailerNBytes = aFlag == true ? sizeof(uint32_t) : 0;
+        return;
+    }
+
+    //*******
+    // writing
+    //*******
+
+    bool MonarchIOCompressed::Write( const byte_type* anArray, size_t aCount )
+    {
+        if( fMode != sAccessWrite || fFailed == true )
+        {
+            return false;
+        }
+        while( aCount > 0 )
+        {
+            Block& tBlock = fBlocks[ (fOldest + fNPending) % fBlocks.size() ];
+            size_t tCount = std::min( aCount, fBlockNBytes - tBlock.fRawNBytes );
+            memcpy( tBlock.fRaw + tBlock.fRawNBytes, anArray, tCount );
+            tBlock.fRawNBytes += tCount;
+            anArray += tCount;
+            aCount -= tCount;
+            if( tBlock.fRawNBytes == fBlockNBytes )
+            {
+                Submit();
+            }
+        }
+        return fFailed == false;
+    }
+
+    void MonarchIOCompressed::Submit()
+    {
+        Block& tBlock = fBlocks[ (fOldest + fNPending) % fBlocks.size() ];
+        if( fNWorkers == 0 )
+        {
+            CompressBlock( tBlock );
+            tBlock.fState = Block::eCompressed;
+        }
+        else
+        {
+            pthread_mutex_lock( &fMutex );
+            tBlock.fState = Block::eQueued;
+            pthread_cond_signal( &fQueued );
+            pthread_mutex_unlock( &fMutex );
+        }
+        ++fNPending;
+
+        // write whatever is ready, and wait for the oldest block if there is nothing left to fill
+        while( fNPending > 0 )
+        {
+            pthread_mutex_lock( &fMutex );
+            bool tReady = fBlocks[ fOldest ].fState == Block::eCompressed;
+            pthread_mutex_unlock( &fMutex );
+            if( tReady == false && fNPending < fBlocks.size() )
+            {
+                break;
+            }
+            if( WriteOldest() == false )
+            {
+                fFailed = true;
+            }
+        }
+        return;
+    }
+
+    bool MonarchIOCompressed::WriteOldest()
+    {
+        Block& tBlock = fBlocks[ fOldest ];
+        pthread_mutex_lock( &fMutex );
+        while( tBlock.fState != Block::eCompressed )
+        {
+            pthread_cond_wait( &fCompressed, &fMutex );
+        }
+        pthread_mutex_unlock( &fMutex );
+
+        bool tWritten = fFailed == false && fIO->Write( &tBlock.fFrame ) == true && fIO->Write( tBlock.fPayload, tBlock.fFrame.fStoredNBytes ) == true;
+        if( tWritten == true && fTrailerNBytes > 0 )
+        {
+            tWritten = fIO->Write( &tBlock.fChecksum );
+        }
+        if( fFooter != NULL )
+        {
+            IndexBlock( tBlock );
+        }
+        fStreamPosition += sizeof(MonarchBlockFrame) + tBlock.fFrame.fStoredNBytes + fTrailerNBytes;
+
+        tBlock.fRawNBytes = 0;
+        tBlock.fState = Block::eFree;
+        fOldest = (fOldest + 1) % fBlocks.size();
+        --fNPending;
+        return tWritten;
+    }
+
+    void MonarchIOCompressed::IndexBlock( const Block& aBlock )
+    {
+        // the records of the block are still there as they were written; the headers are copied out
+        // because records of odd sizes are not aligned
+        unsigned tNRecords = aBlock.fRawNBytes / fRecordNBytes;
+        if( tNRecords == 0 )
+        {
+            return;
+        }
+        MonarchRecordBytes tFirst;
+        MonarchRecordBytes tLast;
+        memcpy( &tFirst, aBlock.fRaw, sizeof(MonarchRecordBytes) );
+        memcpy( &tLast, aBlock.fRaw + (tNRecords - 1) * fRecordNBytes, sizeof(MonarchRecordBytes) );
+        fFooter->AddBlock( fStreamPosition, tNRecords, tFirst.fRecordId, tFirst.fTime, tLast.fTime, tFirst.fAcquisitionId, tLast.fAcquisitionId );
+        return;
+    }
+
+    bool MonarchIOCompressed::Flush()
+    {
+        if( fBlocks[ (fOldest + fNPending) % fBlocks.size() ].fRawNBytes > 0 )
+        {
+            Submit();
+        }
+        while( fNPending > 0 )
+        {
+            if( WriteOldest() == false )
+            {
+                fFailed = true;
+            }
+        }
+        if( fFooter != NULL && fFailed == false )
+        {
+            MonarchBlockFrame tEnd;
+            memset( &tEnd, 0, sizeof(tEnd) );
+            fFooter->SetStoredNBytes( fStreamPosition );
+            if( fIO->Write( &tEnd ) == false || fFooter->MarshalToIO( fIO ) == false )
+            {
+                fFailed = true;
+            }
+        }
+        return fFailed == false;
+    }
+
+    void* MonarchIOCompressed::Run( void* anArgument )
+    {
+        static_cast< MonarchIOCompressed* >( anArgument )->Execute();
+        return NULL;
+    }
+
+    void MonarchIOCompressed::Execute()
+    {
+        pthread_mutex_lock( &fMutex );
+        while( true )
+        {
+            // blocks are queued in ring order, so the next one to take is always at fTake
+            while( fStopping == false && fBlocks[ fTake ].fState != Block::eQueued )
+            {
+                pthread_cond_wait( &fQueued, &fMutex );
+            }
+            if( fBlocks[ fTake ].fState != Block::eQueued )
+            {
+                break;
+            }
+            Block& tBlock = fBlocks[ fTake ];
+            fTake = (fTake + 1) % fBlocks.size();
+            pthread_mutex_unlock( &fMutex );
+
+            CompressBlock( tBlock );
+
+            pthread_mutex_lock( &fMutex );
+            tBlock.fState = Block::eCompressed;
+            pthread_cond_broadcast( &fCompressed );
+        }
+        pthread_mutex_unlock( &fMutex );
+        return;
+    }
+
+    void MonarchIOCompressed::CompressBlock( Block& aBlock )
+    {
+        const byte_type* tSource = aBlock.fRaw;
+        if( fElementNBytes > 1 )
+        {
+            MonarchCompression::Shuffle( aBlock.fRaw, aBlock.fRawNBytes, fElementNBytes, aBlock.fShuffled );
+            tSource = aBlock.fShuffled;
+        }
+        size_t tStoredNBytes = MonarchCompression::Compress( fCompression, tSource, aBlock.fRawNBytes, aBlock.fStored, MonarchCompression::Bound( fCompression, fBlockNBytes ) );
+
+        aBlock.fFrame.fRawNBytes = aBlock.fRawNBytes;
+        if( tStoredNBytes == 0 || tStoredNBytes >= aBlock.fRawNBytes )
+        {
+            // incompressible blocks are kept as they are, so reading them costs a copy and nothing more
+            aBlock.fFrame.fStoredNBytes = aBlock.fRawNBytes;
+            aBlock.fFrame.fCompression = sCompressionNone;
+            aBlock.fFrame.fElementNBytes = 1;
+            aBlock.fPayload = aBlock.fRaw;
+        }
+        else
+        {
+            aBlock.fFrame.fStoredNBytes = tStoredNBytes;
+            aBlock.fFrame.fCompression = fCompression;
+            aBlock.fFrame.fElementNBytes = fElementNBytes > 1 ? fElementNBytes : 1;
+            aBlock.fPayload = aBlock.fStored;
+        }
+
+        // the checksum covers the bytes as they are in the file, so a copy can be checked without decompressing it
+        if( fTrailerNBytes > 0 )
+        {
+            aBlock.fChecksum = MonarchChecksum::Crc32c( (const byte_type*) &aBlock.fFrame, sizeof(MonarchBlockFrame) );
+            aBlock.fChecksum = MonarchChecksum::Crc32c( aBlock.fPayload, aBlock.fFrame.fStoredNBytes, aBlock.fChecksum );
+        }
+        return;
+    }
+
+    //*******
+    // reading
+    //*******
+
+    bool MonarchIOCompressed::ReadFrame( MonarchBlockFrame& aFrame, uint64_t aBlockStart )
+    {
+        if( fIO->Read( &aFrame ) == false )
+        {
+            return false;
+        }
+        if( aFrame.fRawNBytes == 0 )
+        {
+            // the end frame is left unread, so the backend stays where fStreamPosition says and whatever follows it is never taken for a frame
+            fIO->Seek( -(long int) sizeof(MonarchBlockFrame) );
+            return false;
+        }
+        pthread_mutex_lock( &fBlocksMutex );
+        if( fBlockOffsets.empty() == true || fStreamPosition > fBlockOffsets.back() )
+        {
+            fBlockOffsets.push_back( fStreamPosition );
+            fBlockStarts.push_back( aBlockStart );
+        }
+        pthread_mutex_unlock( &fBlocksMutex );
+        fStreamPosition += sizeof(MonarchBlockFrame);
+        return true;
+    }
+
+    bool MonarchIOCompressed::LoadBlock( const MonarchBlockFrame& aFrame )
+    {
+        // the stored bytes and the checksum behind them come in one piece
+        size_t tNBytes = aFrame.fStoredNBytes + fTrailerNBytes;
+        const byte_type* tStored = NULL;
+        if( fIO->IsMapped() == true )
+        {
+            tStored = fIO->Map( tNBytes );
+        }
+        else
+        {
+            fReadStored.resize( tNBytes + 1 );
+            if( tNBytes == 0 || fIO->Read( &fReadStored[ 0 ], tNBytes ) == true )
+            {
+                tStored = &fReadStored[ 0 ];
+            }
+        }
+        if( tStored == NULL )
+        {
+            return false;
+        }
+        fStreamPosition += tNBytes;
+
+        if( DecodeBlock( aFrame, tStored, fBuffer, fReadShuffled ) == false )
+        {
+            return false;
+        }
+        fBufferNBytes = aFrame.fRawNBytes;
+        fBufferPosition = 0;
+        return true;
+    }
+
+    bool MonarchIOCompressed::DecodeBlock( const MonarchBlockFrame& aFrame, const byte_type* aStored, std::vector< byte_type >& aBuffer, std::vector< byte_type >& aShuffled ) const
+    {
+        if( fTrailerNBytes > 0 )
+        {
+            uint32_t tExpected;
+            memcpy( &tExpected, aStored + aFrame.fStoredNBytes, sizeof(tExpected) );
+            uint32_t tChecksum = MonarchChecksum::Crc32c( (const byte_type*) &aFrame, sizeof(MonarchBlockFrame) );
+            if( MonarchChecksum::Crc32c( aStored, aFrame.fStoredNBytes, tChecksum ) != tExpected )
+            {
+                return false;
+            }
+        }
+
+        if( aBuffer.size() < aFrame.fRawNBytes )
+        {
+            aBuffer.resize( aFrame.fRawNBytes );
+        }
+        byte_type* tDestination = &aBuffer[ 0 ];
+        if( aFrame.fElementNBytes > 1 )
+        {
+            aShuffled.resize( aFrame.fRawNBytes );
+            tDestination = &aShuffled[ 0 ];
+        }
+        if( MonarchCompression::Decompress( aFrame.fCompression, aStored, aFrame.fStoredNBytes, tDestination, aFrame.fRawNBytes ) == false )
+        {
+            return false;
+        }
+        if( aFrame.fElementNBytes > 1 )
+        {
+            MonarchCompression::Unshuffle( tDestination, aFrame.fRawNBytes, aFrame.fElementNBytes, &aBuffer[ 0 ] );
+        }
+        return true;
+    }
+
+    bool MonarchIOCompressed::Read( byte_type* anArray, size_t aCount )
+    {
+        if( fMode != sAccessRead )
+        {
+            return false;
+        }
+        while( aCount > 0 )
+        {
+            if( fBufferPosition == fBufferNBytes )
+            {
+                uint64_t tBlockStart = fBufferStart + fBufferNBytes;
+                MonarchBlockFrame tFrame;
+                if( ReadFrame( tFrame, tBlockStart ) == false )
+                {
+                    fDone = true;
+                    return false;
+                }
+                fBufferStart = tBlockStart;
+                fBufferNBytes = 0;
+                fBufferPosition = 0;
+                if( LoadBlock( tFrame ) == false )
+                {
+                    return false;
+                }
+                continue;
+            }
+            size_t tCount = std::min( aCount, fBufferNBytes - fBufferPosition );
+            memcpy( anArray, &fBuffer[ fBufferPosition ], tCount );
+            fBufferPosition += tCount;
+            anArray += tCount;
+            aCount -= tCount;
+        }
+        return true;
+    }
+
+    bool MonarchIOCompressed::Seek( long int aCount )
+    {
+        if( fMode != sAccessRead )
+        {
+            return false;
+        }
+        uint64_t tPosition = fBufferStart + fBufferPosition;
+        if( aCount < 0 && (uint64_t) (-aCount) > tPosition )
+        {
+            return false;
+        }
+        uint64_t tTarget = tPosition + aCount;
+        fDone = false;
+
+        if( tTarget >= fBufferStart && tTarget <= fBufferStart + fBufferNBytes )
+        {
+            fBufferPosition = tTarget - fBufferStart;
+            return true;
+        }
+
+        // go back, or ahead when the index is known, to the last block seen that starts at or before the target
+        pthread_mutex_lock( &fBlocksMutex );
+        size_t tKnown = std::upper_bound( fBlockStarts.begin(), fBlockStarts.end(), tTarget ) - fBlockStarts.begin();
+        uint64_t tKnownOffset = tKnown > 0 ? fBlockOffsets[ tKnown - 1 ] : 0;
+        uint64_t tKnownStart = tKnown > 0 ? fBlockStarts[ tKnown - 1 ] : 0;
+        pthread_mutex_unlock( &fBlocksMutex );
+        if( tKnown > 0 && (tTarget < fBufferStart || tKnownStart > fBufferStart + fBufferNBytes) )
+        {
+            if( fIO->Seek( (long int) tKnownOffset - (long int) fStreamPosition ) == false )
+            {
+                return false;
+            }
+            fStreamPosition = tKnownOffset;
+            fBufferStart = tKnownStart;
+            fBufferNBytes = 0;
+            fBufferPosition = 0;
+        }
+
+        // skip forward over the frames of the blocks in between
+        uint64_t tBlockStart = fBufferStart + fBufferNBytes;
+        while( true )
+        {
+            MonarchBlockFrame tFrame;
+            if( ReadFrame( tFrame, tBlockStart ) == false )
+            {
+                // as with the other backends, seeking past the end succeeds and the next read fails
+                fBufferStart = tTarget;
+                fBufferNBytes = 0;
+                fBufferPosition = 0;
+                fDone = true;
+                return true;
+            }
+            if( tTarget < tBlockStart + tFrame.fRawNBytes )
+            {
+                fBufferStart = tBlockStart;
+                fBufferNBytes = 0;
+                fBufferPosition = 0;
+                if( LoadBlock( tFrame ) == false )
+                {
+                    return false;
+                }
+                fBufferPosition = tTarget - tBlockStart;
+                return true;
+            }
+            if( fIO->Seek( tFrame.fStoredNBytes + fTrailerNBytes ) == false )
+            {
+                return false;
+            }
+            fStreamPosition += tFrame.fStoredNBytes + fTrailerNBytes;
+            tBlockStart += tFrame.fRawNBytes;
+        }
+    }
+
+    void MonarchIOCompressed::DeleteAtBlock( void* anAtBlock )
+    {
+        delete static_cast< AtBlock* >( anAtBlock );
+        return;
+    }
+
+    bool MonarchIOCompressed::FindBlock( uint64_t anOffset, uint64_t& aBlockOffset, uint64_t& aBlockStart )
+    {
+        // the blocks seen so far are known, and the frames of the ones after them are followed from the last one
+        pthread_mutex_lock( &fBlocksMutex );
+        size_t tKnown = std::upper_bound( fBlockStarts.begin(), fBlockStarts.end(), anOffset ) - fBlockStarts.begin();
+        bool tFound = tKnown > 0 && tKnown < fBlockStarts.size();
+        aBlockOffset = tKnown > 0 ? fBlockOffsets[ tKnown - 1 ] : 0;
+        aBlockStart = tKnown > 0 ? fBlockStarts[ tKnown - 1 ] : 0;
+        while( tFound == false )
+        {
+            MonarchBlockFrame tFrame;
+            if( fIO->ReadAt( (byte_type*) &tFrame, sizeof(tFrame), fStart + aBlockOffset ) == false || tFrame.fRawNBytes == 0 )
+            {
+                break;
+            }
+            if( fBlockOffsets.empty() == true )
+            {
+                fBlockOffsets.push_back( aBlockOffset );
+                fBlockStarts.push_back( aBlockStart );
+            }
+            if( anOffset < aBlockStart + tFrame.fRawNBytes )
+            {
+                tFound = true;
+                break;
+            }
+            aBlockOffset += sizeof(MonarchBlockFrame) + tFrame.fStoredNBytes + fTrailerNBytes;
+            aBlockStart += tFrame.fRawNBytes;
+            fBlockOffsets.push_back( aBlockOffset );
+            fBlockStarts.push_back( aBlockStart );
+        }
+        pthread_mutex_unlock( &fBlocksMutex );
+        return tFound;
+    }
+
+    bool MonarchIOCompressed::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        if( fMode != sAccessRead || fHasAtKey == false )
+        {
+            return false;
+        }
+        AtBlock* tBlock = static_cast< AtBlock* >( pthread_getspecific( fAtKey ) );
+        if( tBlock == NULL )
+        {
+            tBlock = new AtBlock();
+            tBlock->fStart = 0;
+            tBlock->fNBytes = 0;
+            pthread_setspecific( fAtKey, tBlock );
+        }
+
+        while( aCount > 0 )
+        {
+            if( anOffset < tBlock->fStart || anOffset >= tBlock->fStart + tBlock->fNBytes )
+            {
+                uint64_t tBlockOffset;
+                uint64_t tBlockStart;
+                if( FindBlock( anOffset, tBlockOffset, tBlockStart ) == false )
+                {
+                    return false;
+                }
+                tBlock->fNBytes = 0;
+
+                MonarchBlockFrame tFrame;
+                if( fIO->ReadAt( (byte_type*) &tFrame, sizeof(tFrame), fStart + tBlockOffset ) == false )
+                {
+                    return false;
+                }
+                size_t tNBytes = tFrame.fStoredNBytes + fTrailerNBytes;
+                const byte_type* tStored = fIO->MapAt( tNBytes, fStart + tBlockOffset + sizeof(tFrame) );
+                if( tStored == NULL )
+                {
+                    tBlock->fStored.resize( tNBytes + 1 );
+                    if( tNBytes > 0 && fIO->ReadAt( &tBlock->fStored[ 0 ], tNBytes, fStart + tBlockOffset + sizeof(tFrame) ) == false )
+                    {
+                        return false;
+                    }
+                    tStored = &tBlock->fStored[ 0 ];
+                }
+                if( DecodeBlock( tFrame, tStored, tBlock->fBuffer, tBlock->fShuffled ) == false )
+                {
+                    return false;
+                }
+                tBlock->fStart = tBlockStart;
+                tBlock->fNBytes = tFrame.fRawNBytes;
+            }
+            size_t tCount = std::min( (uint64_t) aCount, tBlock->fStart + tBlock->fNBytes - anOffset );
+            memcpy( anArray, &tBlock->fBuffer[ anOffset - tBlock->fStart ], tCount );
+            anOffset += tCount;
+            anArray += tCount;
+            aCount -= tCount;
+        }
+        return true;
+    }
+
+    bool MonarchIOCompressed::Done()
+    {
+        return fDone == true && fBufferPosition == fBufferNBytes;
+    }
+
+    bool MonarchIOCompressed::Close()
+    {
+        bool tFlushed = true;
+        if( fMode == sAccessWrite )
+        {
+            tFlushed = Flush();
+        }
+        bool tClosed = fIO->Close();
+        return tFlushed == true && tClosed == true;
+    }
+
+}
@@ -0,0 +1,171 @@
+#ifndef MONARCHIOCOMPRESSED_HPP_
+#define MONARCHIOCOMPRESSED_HPP_
+
+#include "MonarchFooter.hpp"
+#include "MonarchIO.hpp"
+
+#include <pthread.h>
+
+#include <vector>
+
+namespace monarch
+{
+
+    // Frame in front of every block of a compressed or indexed file.
+    // A frame with no bytes of records ends the blocks of a file with a block index.
+    // In a file with checksums, the stored bytes are followed by the CRC32C of the frame and the stored bytes.
+    struct MonarchBlockFrame
+    {
+            // bytes of records in the block
+            uint32_t fRawNBytes;
+            // bytes of the block as stored after the frame
+            uint32_t fStoredNBytes;
+            // codec of the stored bytes; sCompressionNone if compressing did not pay
+            uint32_t fCompression;
+            // size of the elements that were byte shuffled before compressing; 1 if not shuffled
+            uint32_t fElementNBytes;
+    };
+
+    // Block stream of records on top of another backend, for compressed files and files with a block index.
+    // Writing gathers the records into blocks of aBlockSize records of aRecordNBytes bytes, byte shuffles them by anElementNBytes
+    // and compresses them on a pool of worker threads; the blocks are written in order, each behind a MonarchBlockFrame.
+    // Reading decompresses one block at a time and hands out its bytes, so Monarch sees the records as if they
+    // were stored raw. Seeks are in record bytes and skip whole blocks by their frames without decompressing them,
+    // or jump straight to the block when the index is known.
+    // ReadAt finds the block of an offset the same way, through anIO's ReadAt, and keeps the block it decompressed last
+    // for each thread, so reading the records of a block one by one decompresses it once.
+    // The stream takes over anIO, which must be positioned after the header, aStart bytes into the file.
+    class MonarchIOCompressed :
+        public MonarchIO
+    {
+        public:
+            MonarchIOCompressed( MonarchIO* anIO, AccessModeType aMode, CompressionType aCompression, size_t anElementNBytes, size_t aRecordNBytes, size_t aBlockSize, uint64_t aStart = 0 );
+            virtual ~MonarchIOCompressed();
+
+            // Keep a block index in aFooter. When writing, the blocks are added to it as they are written
+            // and Close writes it after the last block; when reading, it is the index of the file to seek with.
+            void SetFooter( MonarchFooter* aFooter );
+
+            // Write a checksum after every block, or expect one when reading. A block that does not match
+            // its checksum fails to read.
+            void SetChecksums( bool aFlag );
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual void SetRecordNBytes( size_t aNBytes );
+            virtual bool Preallocate( uint64_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+
+        private:
+            MonarchIO* fIO;
+            CompressionType fCompression;
+            size_t fElementNBytes;
+            size_t fRecordNBytes;
+            size_t fBlockNBytes;
+            bool fDone;
+            MonarchFooter* fFooter;
+            // bytes after the stored bytes of a block: 4 with checksums, 0 without
+            size_t fTrailerNBytes;
+
+            //*******
+            // writing
+            //*******
+
+            struct Block
+            {
+                    byte_type* fRaw;
+                    size_t fRawNBytes;
+                    byte_type* fShuffled;
+                    byte_type* fStored;
+                    // fStored, or fRaw when the block is kept as it is
+                    const byte_type* fPayload;
+                    MonarchBlockFrame fFrame;
+                    uint32_t fChecksum;
+                    // eFree while it is being filled or written, eQueued until a worker has compressed it, then eCompressed
+                    enum
+                    {
+                        eFree, eQueued, eCompressed
+                    } fState;
+            };
+
+            static const unsigned sMaxWorkers = 4;
+            std::vector< Block > fBlocks;
+            // the oldest block not yet written and the number of blocks submitted since; the block being filled follows them.
+            // fTake is the next block for the workers.
+            unsigned fOldest;
+            unsigned fNPending;
+            unsigned fTake;
+            bool fFailed;
+
+            pthread_t fWorkers[ sMaxWorkers ];
+            unsigned fNWorkers;
+            bool fStopping;
+            pthread_mutex_t fMutex;
+            pthread_cond_t fQueued;
+            pthread_cond_t fCompressed;
+
+            static void* Run( void* anArgument );
+            void Execute();
+            void CompressBlock( Block& aBlock );
+            void IndexBlock( const Block& aBlock );
+            void Submit();
+            bool WriteOldest();
+            bool Flush();
+
+            //*******
+            // reading
+            //*******
+
+            // the decompressed block the cursor is in, and the stored and shuffled bytes on the way to it
+            std::vector< byte_type > fBuffer;
+            std::vector< byte_type > fReadStored;
+            std::vector< byte_type > fReadShuffled;
+            size_t fBufferNBytes;
+            size_t fBufferPosition;
+            // record bytes before the block in the buffer
+            uint64_t fBufferStart;
+
+            // stream offset and record offset of every block seen so far, for seeking back;
+            // ReadAt adds to them from other threads, so they are guarded by fBlocksMutex
+            std::vector< uint64_t > fBlockOffsets;
+            std::vector< uint64_t > fBlockStarts;
+            pthread_mutex_t fBlocksMutex;
+            // stream offset of the next frame; when writing, of the next block to be written
+            uint64_t fStreamPosition;
+
+            bool ReadFrame( MonarchBlockFrame& aFrame, uint64_t aBlockStart );
+            bool LoadBlock( const MonarchBlockFrame& aFrame );
+            // check the checksum of the stored bytes of a block and decompress them into aBuffer
+            bool DecodeBlock( const MonarchBlockFrame& aFrame, const byte_type* aStored, std::vector< byte_type >& aBuffer, std::vector< byte_type >& aShuffled ) const;
+
+            //*************
+            // reading at an offset
+            //*************
+
+            // the block ReadAt decompressed last on a thread
+            struct AtBlock
+            {
+                    uint64_t fStart;
+                    size_t fNBytes;
+                    std::vector< byte_type > fBuffer;
+                    std::vector< byte_type > fStored;
+                    std::vector< byte_type > fShuffled;
+            };
+            pthread_key_t fAtKey;
+            bool fHasAtKey;
+            static void DeleteAtBlock( void* anAtBlock );
+
+            // position of the stream in the file
+            uint64_t fStart;
+
+            // find the stream offset and the record offset of the block that holds record offset anOffset
+            bool FindBlock( uint64_t anOffset, uint64_t& aBlockOffset, uint64_t& aBlockStart );
+    };
+
+}
+
+#endif
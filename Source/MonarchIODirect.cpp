@@ -0,0 +1,302 @@
+#include "MonarchIODirect.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace monarch
+{
+
+    const size_t MonarchIODirect::sAlignment;
+    const size_t MonarchIODirect::sWindowSize;
+
+    MonarchIODirect::MonarchIODirect( AccessModeType aMode ) :
+            MonarchIO( aMode ),
+            fDescriptor( -1 ),
+            fWindow( NULL ),
+            fWindowOffset( 0 ),
+            fWindowSize( 0 ),
+            fPosition( 0 ),
+            fDone( false )
+    {
+    }
+    MonarchIODirect::~MonarchIODirect()
+    {
+        if( fDescriptor >= 0 )
+        {
+            Close();
+        }
+        free( fWindow );
+    }
+
+    bool MonarchIODirect::Open( const string& aFilename )
+    {
+        int tFlags = 0;
+        if( fMode == sAccessRead )
+        {
+            tFlags = O_RDONLY;
+        }
+        else if( fMode == sAccessWrite )
+        {
+            tFlags = O_WRONLY | O_CREAT | O_TRUNC;
+        }
+#ifdef O_DIRECT
+        tFlags |= O_DIRECT;
+#endif
+        fDescriptor = open( aFilename.c_str(), tFlags, 0666 );
+        if( fDescriptor < 0 )
+        {
+            return false;
+        }
+#if !defined( O_DIRECT ) && defined( F_NOCACHE )
+        fcntl( fDescriptor, F_NOCACHE, 1 );
+#endif
+
+        if( fWindow == NULL && posix_memalign( reinterpret_cast< void** >( &fWindow ), sAlignment, sWindowSize ) != 0 )
+        {
+            fWindow = NULL;
+            close( fDescriptor );
+            fDescriptor = -1;
+            return false;
+        }
+
+        fWindowOffset = 0;
+        fWindowSize = 0;
+        fPosition = 0;
+        fDone = false;
+        return true;
+    }
+
+    bool MonarchIODirect::FillWindow()
+    {
+        fWindowOffset = fPosition - fPosition % sAlignment;
+        fWindowSize = 0;
+        while( true )
+        {
+            ssize_t tRead = pread( fDescriptor, fWindow, sWindowSize, fWindowOffset );
+            if( tRead < 0 )
+            {
+                if( errno == EINTR ) continue;
+                return false;
+            }
+            fWindowSize = tRead;
+            break;
+        }
+        if( fPosition >= fWindowOffset + (off_t)fWindowSize )
+        {
+            fDone = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool MonarchIODirect::Read( byte_type* anArray, size_t aCount )
+    {
+        while( aCount > 0 )
+        {
+            if( fPosition < fWindowOffset || fPosition >= fWindowOffset + (off_t)fWindowSize )
+            {
+                // large aligned requests don't need the window
+                if( aCount >= sAlignment && IsAligned( anArray, aCount - aCount % sAlignment, fPosition ) )
+                {
+                    size_t tDirectCount = aCount - aCount % sAlignment;
+                    ssize_t tRead = pread( fDescriptor, anArray, tDirectCount, fPosition );
+                    if( tRead < 0 )
+                    {
+                        if( errno == EINTR ) continue;
+                        return false;
+                    }
+                    if( tRead == 0 )
+                    {
+                        fDone = true;
+                        return false;
+                    }
+                    anArray += tRead;
+                    aCount -= tRead;
+                    fPosition += tRead;
+                    continue;
+                }
+                if( FillWindow() == false )
+                {
+                    return false;
+                }
+            }
+            size_t tAvailable = fWindowOffset + fWindowSize - fPosition;
+            size_t tCopy = aCount < tAvailable ? aCount : tAvailable;
+            memcpy( anArray, fWindow + (fPosition - fWindowOffset), tCopy );
+            anArray += tCopy;
+            aCount -= tCopy;
+            fPosition += tCopy;
+        }
+        return true;
+    }
+
+    bool MonarchIODirect::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        if( fDescriptor < 0 || fMode != sAccessRead )
+        {
+            return false;
+        }
+        if( IsAligned( anArray, aCount, anOffset ) == true )
+        {
+            return ReadFully( fDescriptor, anArray, aCount, anOffset );
+        }
+
+        // anything else goes through aligned scratch space of its own, since the window belongs to the cursor
+        uint64_t tStart = anOffset - anOffset % sAlignment;
+        uint64_t tEnd = (anOffset + aCount + sAlignment - 1) / sAlignment * sAlignment;
+        byte_type* tScratch = NULL;
+        if( posix_memalign( reinterpret_cast< void** >( &tScratch ), sAlignment, tEnd - tStart ) != 0 )
+        {
+            return false;
+        }
+        // the last block of the file may be short, so only the bytes asked for have to be there
+        size_t tDone = 0;
+        while( tStart + tDone < anOffset + aCount )
+        {
+            ssize_t tRead = pread( fDescriptor, tScratch + tDone, tEnd - tStart - tDone, tStart + tDone );
+            if( tRead < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            if( tRead <= 0 )
+            {
+                break;
+            }
+            tDone += tRead;
+        }
+        bool tSuccess = tStart + tDone >= anOffset + aCount;
+        if( tSuccess == true )
+        {
+            memcpy( anArray, tScratch + (anOffset - tStart), aCount );
+        }
+        free( tScratch );
+        return tSuccess;
+    }
+
+    bool MonarchIODirect::FlushWindow( bool aPad )
+    {
+        size_t tCount = fWindowSize;
+        if( aPad == true && tCount % sAlignment != 0 )
+        {
+            size_t tPadding = sAlignment - tCount % sAlignment;
+            memset( fWindow + tCount, 0, tPadding );
+            tCount += tPadding;
+        }
+        size_t tDone = 0;
+        while( tDone < tCount )
+        {
+            ssize_t tWritten = pwrite( fDescriptor, fWindow + tDone, tCount - tDone, fWindowOffset + tDone );
+            if( tWritten < 0 )
+            {
+                if( errno == EINTR ) continue;
+                return false;
+            }
+            tDone += tWritten;
+        }
+        return true;
+    }
+
+    bool MonarchIODirect::Write( const byte_type* anArray, size_t aCount )
+    {
+        while( aCount > 0 )
+        {
+            // large aligned requests don't need the window
+            if( fWindowSize == 0 && aCount >= sAlignment && IsAligned( anArray, aCount - aCount % sAlignment, fPosition ) )
+            {
+                size_t tDirectCount = aCount - aCount % sAlignment;
+                ssize_t tWritten = pwrite( fDescriptor, anArray, tDirectCount, fPosition );
+                if( tWritten < 0 )
+                {
+                    if( errno == EINTR ) continue;
+                    return false;
+                }
+                anArray += tWritten;
+                aCount -= tWritten;
+                fPosition += tWritten;
+                fWindowOffset = fPosition;
+                continue;
+            }
+
+            size_t tCopy = sWindowSize - fWindowSize;
+            if( tCopy > aCount ) tCopy = aCount;
+            memcpy( fWindow + fWindowSize, anArray, tCopy );
+            fWindowSize += tCopy;
+            anArray += tCopy;
+            aCount -= tCopy;
+            fPosition += tCopy;
+
+            if( fWindowSize == sWindowSize )
+            {
+                if( FlushWindow( false ) == false )
+                {
+                    return false;
+                }
+                fWindowOffset += fWindowSize;
+                fWindowSize = 0;
+            }
+        }
+        return true;
+    }
+
+    bool MonarchIODirect::Seek( long int aCount )
+    {
+        if( fMode == sAccessWrite )
+        {
+            // append only
+            return aCount == 0;
+        }
+        if( aCount < 0 && -aCount > fPosition )
+        {
+            return false;
+        }
+        fPosition += aCount;
+        return true;
+    }
+
+    bool MonarchIODirect::Done()
+    {
+        return fDone;
+    }
+
+    bool MonarchIODirect::Preallocate( uint64_t aNBytes )
+    {
+        if( fDescriptor < 0 || fMode != sAccessWrite )
+        {
+            return false;
+        }
+        return Reserve( fDescriptor, aNBytes );
+    }
+
+    bool MonarchIODirect::Close()
+    {
+        if( fDescriptor < 0 )
+        {
+            return false;
+        }
+
+        bool tSuccess = true;
+        if( fMode == sAccessWrite && fWindowSize > 0 )
+        {
+            tSuccess = FlushWindow( true );
+            if( ftruncate( fDescriptor, fPosition ) != 0 )
+            {
+                tSuccess = false;
+            }
+            fWindowSize = 0;
+        }
+        if( fReservedNBytes > 0 )
+        {
+            Release( fDescriptor, fPosition );
+        }
+
+        if( close( fDescriptor ) != 0 )
+        {
+            tSuccess = false;
+        }
+        fDescriptor = -1;
+        return tSuccess;
+    }
+
+}
@@ -0,0 +1,56 @@
+#ifndef MONARCHIODIRECT_HPP_
+#define MONARCHIODIRECT_HPP_
+
+#include "MonarchIO.hpp"
+
+#include <sys/types.h>
+
+namespace monarch
+{
+
+    // Cache-bypassing backend (sIODirect) using O_DIRECT (F_NOCACHE on OS X).
+    // Unaligned requests are staged through an aligned window; requests that are already aligned
+    // in memory, offset and size go straight to the device.
+    // Writing is append-only; the padding of the last block is truncated away on Close().
+    class MonarchIODirect :
+        public MonarchIO
+    {
+        public:
+            static const size_t sAlignment = 4096;
+            static const size_t sWindowSize = 4 * 1024 * 1024;
+
+        private:
+            int fDescriptor;
+            byte_type* fWindow;
+            off_t fWindowOffset;
+            size_t fWindowSize;
+            off_t fPosition;
+            bool fDone;
+
+            bool FillWindow();
+            bool FlushWindow( bool aPad );
+
+        public:
+            MonarchIODirect( AccessModeType aMode );
+            virtual ~MonarchIODirect();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual bool Preallocate( uint64_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+
+            static bool IsAligned( const void* aPointer, size_t aCount, off_t anOffset );
+    };
+
+    inline bool MonarchIODirect::IsAligned( const void* aPointer, size_t aCount, off_t anOffset )
+    {
+        return ( (size_t)aPointer % sAlignment == 0 ) && ( aCount % sAlignment == 0 ) && ( anOffset % sAlignment == 0 );
+    }
+
+}
+
+#endif
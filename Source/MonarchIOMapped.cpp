@@ -0,0 +1,86 @@
+#include "MonarchIOMapped.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace monarch
+{
+
+    MonarchIOMapped::MonarchIOMapped( AccessModeType aMode ) :
+            MonarchIO( aMode ),
+            fMap( NULL ),
+            fMapSize( 0 ),
+            fMapPosition( 0 )
+    {
+    }
+    MonarchIOMapped::~MonarchIOMapped()
+    {
+        Close();
+    }
+
+    bool MonarchIOMapped::Open( const string& aFilename )
+    {
+        if( fMode != sAccessRead )
+        {
+            return false;
+        }
+
+        int tDescriptor = open( aFilename.c_str(), O_RDONLY );
+        if( tDescriptor < 0 )
+        {
+            return false;
+        }
+
+        struct stat tStat;
+        if( fstat( tDescriptor, &tStat ) != 0 || tStat.st_size == 0 )
+        {
+            close( tDescriptor );
+            return false;
+        }
+
+        void* tMap = mmap( NULL, tStat.st_size, PROT_READ, MAP_PRIVATE, tDescriptor, 0 );
+        // the mapping keeps its own reference to the file
+        close( tDescriptor );
+        if( tMap == MAP_FAILED )
+        {
+            return false;
+        }
+        madvise( tMap, tStat.st_size, MADV_SEQUENTIAL );
+
+        fMap = static_cast< const byte_type* >( tMap );
+        fMapSize = tStat.st_size;
+        fMapPosition = 0;
+        return true;
+    }
+
+    bool MonarchIOMapped::Write( const byte_type*, size_t )
+    {
+        return false;
+    }
+
+    bool MonarchIOMapped::IsMapped() const
+    {
+        return fMap != NULL;
+    }
+
+    bool MonarchIOMapped::Done()
+    {
+        return fMapPosition >= fMapSize;
+    }
+
+    bool MonarchIOMapped::Close()
+    {
+        if( fMap != NULL )
+        {
+            int tResult = munmap( const_cast< byte_type* >( fMap ), fMapSize );
+            fMap = NULL;
+            fMapSize = 0;
+            fMapPosition = 0;
+            return tResult == 0;
+        }
+        return false;
+    }
+
+}
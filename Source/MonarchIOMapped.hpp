@@ -0,0 +1,89 @@
+#ifndef MONARCHIOMAPPED_HPP_
+#define MONARCHIOMAPPED_HPP_
+
+#include "MonarchIO.hpp"
+
+namespace monarch
+{
+
+    // Read-only memory mapping of the whole file (sIOMapped).
+    // Map() hands out pointers into the mapping, so records can be read without copying.
+    class MonarchIOMapped :
+        public MonarchIO
+    {
+            const byte_type* fMap;
+            size_t fMapSize;
+            size_t fMapPosition;
+
+        public:
+            MonarchIOMapped( AccessModeType aMode );
+            virtual ~MonarchIOMapped();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual const byte_type* Map( size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual const byte_type* MapAt( size_t aCount, uint64_t anOffset );
+            virtual bool IsMapped() const;
+            virtual bool Done();
+            virtual bool Close();
+    };
+
+    inline bool MonarchIOMapped::Seek( long int aCount )
+    {
+        if( aCount < 0 && (size_t)(-aCount) > fMapPosition )
+        {
+            return false;
+        }
+        fMapPosition += aCount;
+        return true;
+    }
+
+    inline bool MonarchIOMapped::Read( byte_type* anArray, size_t aCount )
+    {
+        const byte_type* tSource = Map( aCount );
+        if( tSource == NULL )
+        {
+            return false;
+        }
+        memcpy( anArray, tSource, aCount );
+        return true;
+    }
+
+    inline const byte_type* MonarchIOMapped::MapAt( size_t aCount, uint64_t anOffset )
+    {
+        if( anOffset > fMapSize || aCount > fMapSize - anOffset )
+        {
+            return NULL;
+        }
+        return fMap + anOffset;
+    }
+
+    inline bool MonarchIOMapped::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        const byte_type* tSource = MapAt( aCount, anOffset );
+        if( tSource == NULL )
+        {
+            return false;
+        }
+        memcpy( anArray, tSource, aCount );
+        return true;
+    }
+
+    inline const byte_type* MonarchIOMapped::Map( size_t aCount )
+    {
+        if( fMapPosition > fMapSize || aCount > fMapSize - fMapPosition )
+        {
+            fMapPosition = fMapSize;
+            return NULL;
+        }
+        const byte_type* tPointer = fMap + fMapPosition;
+        fMapPosition += aCount;
+        return tPointer;
+    }
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "MonarchIOPositional.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace monarch
+{
+
+    MonarchIOPositional::MonarchIOPositional( AccessModeType aMode ) :
+            MonarchIO( aMode ),
+            fDescriptor( -1 ),
+            fPosition( 0 ),
+            fDone( false )
+    {
+    }
+    MonarchIOPositional::~MonarchIOPositional()
+    {
+        if( fDescriptor >= 0 )
+        {
+            close( fDescriptor );
+        }
+    }
+
+    bool MonarchIOPositional::Open( const string& aFilename )
+    {
+        if( fMode == sAccessRead )
+        {
+            fDescriptor = open( aFilename.c_str(), O_RDONLY );
+#ifdef POSIX_FADV_SEQUENTIAL
+            if( fDescriptor >= 0 )
+            {
+                posix_fadvise( fDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL );
+            }
+#endif
+        }
+        else if( fMode == sAccessWrite )
+        {
+            fDescriptor = open( aFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+        }
+
+        fPosition = 0;
+        fDone = false;
+        return fDescriptor >= 0;
+    }
+
+    bool MonarchIOPositional::Write( const byte_type* anArray, size_t aCount )
+    {
+        while( aCount > 0 )
+        {
+            ssize_t tWritten = pwrite( fDescriptor, anArray, aCount, fPosition );
+            if( tWritten < 0 )
+            {
+                if( errno == EINTR ) continue;
+                return false;
+            }
+            anArray += tWritten;
+            aCount -= tWritten;
+            fPosition += tWritten;
+        }
+        return true;
+    }
+
+    bool MonarchIOPositional::Seek( long int aCount )
+    {
+        if( aCount < 0 && -aCount > fPosition )
+        {
+            return false;
+        }
+        fPosition += aCount;
+        return true;
+    }
+
+    bool MonarchIOPositional::Read( byte_type* anArray, size_t aCount )
+    {
+        while( aCount > 0 )
+        {
+            ssize_t tRead = pread( fDescriptor, anArray, aCount, fPosition );
+            if( tRead < 0 )
+            {
+                if( errno == EINTR ) continue;
+                return false;
+            }
+            if( tRead == 0 )
+            {
+                fDone = true;
+                return false;
+            }
+            anArray += tRead;
+            aCount -= tRead;
+            fPosition += tRead;
+        }
+        return true;
+    }
+
+    bool MonarchIOPositional::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        if( fDescriptor < 0 || fMode != sAccessRead )
+        {
+            return false;
+        }
+        return ReadFully( fDescriptor, anArray, aCount, anOffset );
+    }
+
+    bool MonarchIOPositional::Done()
+    {
+        return fDone;
+    }
+
+    bool MonarchIOPositional::Preallocate( uint64_t aNBytes )
+    {
+        if( fDescriptor < 0 || fMode != sAccessWrite )
+        {
+            return false;
+        }
+        return Reserve( fDescriptor, aNBytes );
+    }
+
+    bool MonarchIOPositional::Close()
+    {
+        if( fDescriptor >= 0 )
+        {
+            if( fReservedNBytes > 0 )
+            {
+                Release( fDescriptor, fPosition );
+            }
+            int tResult = close( fDescriptor );
+            fDescriptor = -1;
+            return tResult == 0;
+        }
+        return false;
+    }
+
+}
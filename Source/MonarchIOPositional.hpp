@@ -0,0 +1,36 @@
+#ifndef MONARCHIOPOSITIONAL_HPP_
+#define MONARCHIOPOSITIONAL_HPP_
+
+#include "MonarchIO.hpp"
+
+#include <sys/types.h>
+
+namespace monarch
+{
+
+    // POSIX pread/pwrite backend (sIOPositional).
+    // Keeps its own offset and bypasses the stdio buffer, so each record is copied once, from the page cache.
+    class MonarchIOPositional :
+        public MonarchIO
+    {
+            int fDescriptor;
+            off_t fPosition;
+            bool fDone;
+
+        public:
+            MonarchIOPositional( AccessModeType aMode );
+            virtual ~MonarchIOPositional();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual bool Preallocate( uint64_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+    };
+
+}
+
+#endif
@@ -0,0 +1,755 @@
+#include "MonarchIOReadAhead.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef Monarch_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace monarch
+{
+
+    const unsigned MonarchIOReadAhead::sDepth;
+    const size_t MonarchIOReadAhead::sMinChunkNBytes;
+    const size_t MonarchIOReadAhead::sAlignment;
+
+    //*****************************************************
+    // engines that carry out the reads into the buffers
+    //*****************************************************
+
+    class MonarchReadAheadEngine
+    {
+        public:
+            virtual ~MonarchReadAheadEngine()
+            {
+            }
+
+            // start reading aCount bytes at anOffset into buffer aBuffer
+            virtual bool Submit( unsigned aBuffer, off_t anOffset, size_t aCount ) = 0;
+
+            // wait for the read into aBuffer; returns the number of bytes read, or -1 on error
+            virtual ssize_t Wait( unsigned aBuffer ) = 0;
+
+            virtual bool IsIOUring() const = 0;
+    };
+
+#ifdef Monarch_HAVE_IO_URING
+
+    class MonarchReadAheadURing :
+        public MonarchReadAheadEngine
+    {
+        public:
+            MonarchReadAheadURing( int aDescriptor, byte_type** aBuffers, unsigned aNBuffers, size_t aBufferNBytes );
+            virtual ~MonarchReadAheadURing();
+
+            bool IsReady() const;
+
+            virtual bool Submit( unsigned aBuffer, off_t anOffset, size_t aCount );
+            virtual ssize_t Wait( unsigned aBuffer );
+            virtual bool IsIOUring() const;
+
+        private:
+            int Enter( unsigned aToSubmit, unsigned aMinComplete, unsigned aFlags );
+            void Reap();
+            void Drain();
+
+            int fDescriptor;
+            int fRing;
+            byte_type** fBuffers;
+            bool fRegistered;
+
+            void* fSQMap;
+            size_t fSQMapNBytes;
+            void* fCQMap;
+            size_t fCQMapNBytes;
+            io_uring_sqe* fSQEs;
+            size_t fSQEsNBytes;
+
+            unsigned* fSQTail;
+            unsigned* fSQMask;
+            unsigned* fSQArray;
+            unsigned* fCQHead;
+            unsigned* fCQTail;
+            unsigned* fCQMask;
+            io_uring_cqe* fCQEs;
+
+            // a read is pending from its submission until its completion is reaped, and complete until it is waited for;
+            // once waiting fails the ring is broken, and no more reads are submitted to it
+            bool fPending[ MonarchIOReadAhead::sDepth ];
+            bool fComplete[ MonarchIOReadAhead::sDepth ];
+            ssize_t fResult[ MonarchIOReadAhead::sDepth ];
+            bool fBroken;
+    };
+
+    MonarchReadAheadURing::MonarchReadAheadURing( int aDescriptor, byte_type** aBuffers, unsigned aNBuffers, size_t aBufferNBytes ) :
+            fDescriptor( aDescriptor ),
+            fRing( -1 ),
+            fBuffers( aBuffers ),
+            fRegistered( false ),
+            fSQMap( MAP_FAILED ),
+            fSQMapNBytes( 0 ),
+            fCQMap( MAP_FAILED ),
+            fCQMapNBytes( 0 ),
+            fSQEs( (io_uring_sqe*)MAP_FAILED ),
+            fSQEsNBytes( 0 ),
+            fBroken( false )
+    {
+        for( unsigned tIndex = 0; tIndex < MonarchIOReadAhead::sDepth; ++tIndex )
+        {
+            fPending[ tIndex ] = false;
+            fComplete[ tIndex ] = false;
+            fResult[ tIndex ] = 0;
+        }
+
+        io_uring_params tParams;
+        memset( &tParams, 0, sizeof(tParams) );
+        fRing = syscall( __NR_io_uring_setup, aNBuffers, &tParams );
+        if( fRing < 0 )
+        {
+            fRing = -1;
+            return;
+        }
+
+        fSQMapNBytes = tParams.sq_off.array + tParams.sq_entries * sizeof(unsigned);
+        fCQMapNBytes = tParams.cq_off.cqes + tParams.cq_entries * sizeof(io_uring_cqe);
+        if( (tParams.features & IORING_FEAT_SINGLE_MMAP) != 0 && fCQMapNBytes > fSQMapNBytes )
+        {
+            fSQMapNBytes = fCQMapNBytes;
+        }
+        fSQMap = mmap( NULL, fSQMapNBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fRing, IORING_OFF_SQ_RING );
+        if( fSQMap == MAP_FAILED )
+        {
+            return;
+        }
+        if( (tParams.features & IORING_FEAT_SINGLE_MMAP) != 0 )
+        {
+            fCQMap = fSQMap;
+        }
+        else
+        {
+            fCQMap = mmap( NULL, fCQMapNBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fRing, IORING_OFF_CQ_RING );
+            if( fCQMap == MAP_FAILED )
+            {
+                return;
+            }
+        }
+        fSQEsNBytes = tParams.sq_entries * sizeof(io_uring_sqe);
+        fSQEs = (io_uring_sqe*)mmap( NULL, fSQEsNBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fRing, IORING_OFF_SQES );
+        if( fSQEs == MAP_FAILED )
+        {
+            return;
+        }
+
+        byte_type* tSQ = static_cast< byte_type* >( fSQMap );
+        fSQTail = reinterpret_cast< unsigned* >( tSQ + tParams.sq_off.tail );
+        fSQMask = reinterpret_cast< unsigned* >( tSQ + tParams.sq_off.ring_mask );
+        fSQArray = reinterpret_cast< unsigned* >( tSQ + tParams.sq_off.array );
+        byte_type* tCQ = static_cast< byte_type* >( fCQMap );
+        fCQHead = reinterpret_cast< unsigned* >( tCQ + tParams.cq_off.head );
+        fCQTail = reinterpret_cast< unsigned* >( tCQ + tParams.cq_off.tail );
+        fCQMask = reinterpret_cast< unsigned* >( tCQ + tParams.cq_off.ring_mask );
+        fCQEs = reinterpret_cast< io_uring_cqe* >( tCQ + tParams.cq_off.cqes );
+
+        // fixed buffers save the kernel from mapping the pages on every read; plain reads work too
+        iovec tVectors[ MonarchIOReadAhead::sDepth ];
+        for( unsigned tIndex = 0; tIndex < aNBuffers; ++tIndex )
+        {
+            tVectors[ tIndex ].iov_base = aBuffers[ tIndex ];
+            tVectors[ tIndex ].iov_len = aBufferNBytes;
+        }
+        fRegistered = syscall( __NR_io_uring_register, fRing, IORING_REGISTER_BUFFERS, tVectors, aNBuffers ) == 0;
+    }
+
+    MonarchReadAheadURing::~MonarchReadAheadURing()
+    {
+        if( fSQEs != MAP_FAILED ) munmap( fSQEs, fSQEsNBytes );
+        if( fCQMap != MAP_FAILED && fCQMap != fSQMap ) munmap( fCQMap, fCQMapNBytes );
+        if( fSQMap != MAP_FAILED ) munmap( fSQMap, fSQMapNBytes );
+        if( fRing >= 0 ) close( fRing );
+    }
+
+    bool MonarchReadAheadURing::IsReady() const
+    {
+        return fRing >= 0 && fSQMap != MAP_FAILED && fCQMap != MAP_FAILED && fSQEs != MAP_FAILED;
+    }
+
+    int MonarchReadAheadURing::Enter( unsigned aToSubmit, unsigned aMinComplete, unsigned aFlags )
+    {
+        while( true )
+        {
+            int tResult = syscall( __NR_io_uring_enter, fRing, aToSubmit, aMinComplete, aFlags, NULL, 0 );
+            if( tResult < 0 && errno == EINTR ) continue;
+            return tResult;
+        }
+    }
+
+    bool MonarchReadAheadURing::Submit( unsigned aBuffer, off_t anOffset, size_t aCount )
+    {
+        if( fBroken == true )
+        {
+            return false;
+        }
+
+        unsigned tTail = *fSQTail;
+        unsigned tIndex = tTail & *fSQMask;
+        io_uring_sqe* tSQE = &fSQEs[ tIndex ];
+        memset( tSQE, 0, sizeof(io_uring_sqe) );
+        tSQE->opcode = fRegistered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        tSQE->fd = fDescriptor;
+        tSQE->off = anOffset;
+        tSQE->addr = (uint64_t)(size_t)fBuffers[ aBuffer ];
+        tSQE->len = aCount;
+        tSQE->buf_index = aBuffer;
+        tSQE->user_data = aBuffer;
+        fSQArray[ tIndex ] = tIndex;
+        __atomic_store_n( fSQTail, tTail + 1, __ATOMIC_RELEASE );
+
+        if( Enter( 1, 0, 0 ) != 1 )
+        {
+            // the kernel has not taken the entry; left in the ring, it would go in with the next submission into a buffer in use
+            __atomic_store_n( fSQTail, tTail, __ATOMIC_RELEASE );
+            return false;
+        }
+        fPending[ aBuffer ] = true;
+        fComplete[ aBuffer ] = false;
+        return true;
+    }
+
+    void MonarchReadAheadURing::Reap()
+    {
+        unsigned tHead = *fCQHead;
+        unsigned tTail = __atomic_load_n( fCQTail, __ATOMIC_ACQUIRE );
+        while( tHead != tTail )
+        {
+            const io_uring_cqe& tCQE = fCQEs[ tHead & *fCQMask ];
+            fResult[ tCQE.user_data ] = tCQE.res;
+            fPending[ tCQE.user_data ] = false;
+            fComplete[ tCQE.user_data ] = true;
+            ++tHead;
+        }
+        __atomic_store_n( fCQHead, tHead, __ATOMIC_RELEASE );
+        return;
+    }
+
+    void MonarchReadAheadURing::Drain()
+    {
+        // the kernel may still write into the buffers of the reads in flight, so none of them is reused before they are all done;
+        // entering the ring is what failed, so their completions are polled for
+        while( true )
+        {
+            Reap();
+            bool tPending = false;
+            for( unsigned tIndex = 0; tIndex < MonarchIOReadAhead::sDepth; ++tIndex )
+            {
+                if( fPending[ tIndex ] == true )
+                {
+                    tPending = true;
+                }
+            }
+            if( tPending == false )
+            {
+                return;
+            }
+            sched_yield();
+        }
+    }
+
+    ssize_t MonarchReadAheadURing::Wait( unsigned aBuffer )
+    {
+        while( fComplete[ aBuffer ] == false )
+        {
+            if( fPending[ aBuffer ] == false )
+            {
+                return -1;
+            }
+            Reap();
+            if( fComplete[ aBuffer ] == true )
+            {
+                break;
+            }
+            if( Enter( 0, 1, IORING_ENTER_GETEVENTS ) < 0 )
+            {
+                // the read may still be in flight, so the ring is given up once it is drained, before the caller reads with pread
+                fBroken = true;
+                Drain();
+                fComplete[ aBuffer ] = false;
+                return -1;
+            }
+        }
+        fComplete[ aBuffer ] = false;
+        return fResult[ aBuffer ] < 0 ? -1 : fResult[ aBuffer ];
+    }
+
+    bool MonarchReadAheadURing::IsIOUring() const
+    {
+        return true;
+    }
+
+#endif
+
+    class MonarchReadAheadThread :
+        public MonarchReadAheadEngine
+    {
+        public:
+            MonarchReadAheadThread( int aDescriptor, byte_type** aBuffers );
+            virtual ~MonarchReadAheadThread();
+
+            bool IsReady() const;
+
+            virtual bool Submit( unsigned aBuffer, off_t anOffset, size_t aCount );
+            virtual ssize_t Wait( unsigned aBuffer );
+            virtual bool IsIOUring() const;
+
+        private:
+            static void* Run( void* anArgument );
+            void Execute();
+
+            int fDescriptor;
+            byte_type** fBuffers;
+
+            // requests in submission order
+            unsigned fQueue[ MonarchIOReadAhead::sDepth ];
+            unsigned fQueueHead;
+            unsigned fQueueSize;
+
+            off_t fOffset[ MonarchIOReadAhead::sDepth ];
+            size_t fCount[ MonarchIOReadAhead::sDepth ];
+            ssize_t fResult[ MonarchIOReadAhead::sDepth ];
+            bool fComplete[ MonarchIOReadAhead::sDepth ];
+
+            bool fStopping;
+            bool fRunning;
+            pthread_t fThread;
+            pthread_mutex_t fMutex;
+            pthread_cond_t fRequested;
+            pthread_cond_t fCompleted;
+    };
+
+    MonarchReadAheadThread::MonarchReadAheadThread( int aDescriptor, byte_type** aBuffers ) :
+            fDescriptor( aDescriptor ),
+            fBuffers( aBuffers ),
+            fQueueHead( 0 ),
+            fQueueSize( 0 ),
+            fStopping( false ),
+            fRunning( false )
+    {
+        for( unsigned tIndex = 0; tIndex < MonarchIOReadAhead::sDepth; ++tIndex )
+        {
+            fComplete[ tIndex ] = false;
+            fResult[ tIndex ] = 0;
+        }
+        pthread_mutex_init( &fMutex, NULL );
+        pthread_cond_init( &fRequested, NULL );
+        pthread_cond_init( &fCompleted, NULL );
+        fRunning = pthread_create( &fThread, NULL, &MonarchReadAheadThread::Run, this ) == 0;
+    }
+
+    MonarchReadAheadThread::~MonarchReadAheadThread()
+    {
+        if( fRunning == true )
+        {
+            pthread_mutex_lock( &fMutex );
+            fStopping = true;
+            pthread_cond_signal( &fRequested );
+            pthread_mutex_unlock( &fMutex );
+            pthread_join( fThread, NULL );
+        }
+        pthread_cond_destroy( &fCompleted );
+        pthread_cond_destroy( &fRequested );
+        pthread_mutex_destroy( &fMutex );
+    }
+
+    bool MonarchReadAheadThread::IsReady() const
+    {
+        return fRunning;
+    }
+
+    bool MonarchReadAheadThread::Submit( unsigned aBuffer, off_t anOffset, size_t aCount )
+    {
+        pthread_mutex_lock( &fMutex );
+        fOffset[ aBuffer ] = anOffset;
+        fCount[ aBuffer ] = aCount;
+        fComplete[ aBuffer ] = false;
+        fQueue[ (fQueueHead + fQueueSize) % MonarchIOReadAhead::sDepth ] = aBuffer;
+        ++fQueueSize;
+        pthread_cond_signal( &fRequested );
+        pthread_mutex_unlock( &fMutex );
+        return true;
+    }
+
+    ssize_t MonarchReadAheadThread::Wait( unsigned aBuffer )
+    {
+        pthread_mutex_lock( &fMutex );
+        while( fComplete[ aBuffer ] == false )
+        {
+            pthread_cond_wait( &fCompleted, &fMutex );
+        }
+        fComplete[ aBuffer ] = false;
+        ssize_t tResult = fResult[ aBuffer ];
+        pthread_mutex_unlock( &fMutex );
+        return tResult;
+    }
+
+    bool MonarchReadAheadThread::IsIOUring() const
+    {
+        return false;
+    }
+
+    void* MonarchReadAheadThread::Run( void* anArgument )
+    {
+        static_cast< MonarchReadAheadThread* >( anArgument )->Execute();
+        return NULL;
+    }
+
+    void MonarchReadAheadThread::Execute()
+    {
+        pthread_mutex_lock( &fMutex );
+        while( true )
+        {
+            while( fQueueSize == 0 && fStopping == false )
+            {
+                pthread_cond_wait( &fRequested, &fMutex );
+            }
+            if( fQueueSize == 0 )
+            {
+                break;
+            }
+            unsigned tBuffer = fQueue[ fQueueHead ];
+            fQueueHead = (fQueueHead + 1) % MonarchIOReadAhead::sDepth;
+            --fQueueSize;
+            off_t tOffset = fOffset[ tBuffer ];
+            size_t tCount = fCount[ tBuffer ];
+            pthread_mutex_unlock( &fMutex );
+
+            ssize_t tRead = 0;
+            while( true )
+            {
+                tRead = pread( fDescriptor, fBuffers[ tBuffer ], tCount, tOffset );
+                if( tRead < 0 && errno == EINTR ) continue;
+                break;
+            }
+
+            pthread_mutex_lock( &fMutex );
+            fResult[ tBuffer ] = tRead;
+            fComplete[ tBuffer ] = true;
+            pthread_cond_broadcast( &fCompleted );
+        }
+        pthread_mutex_unlock( &fMutex );
+        return;
+    }
+
+    //*****************************************************
+    // the backend
+    //*****************************************************
+
+    MonarchIOReadAhead::MonarchIOReadAhead( AccessModeType aMode ) :
+            MonarchIO( aMode ),
+            fDescriptor( -1 ),
+            fPosition( 0 ),
+            fDone( false ),
+            fEngine( NULL ),
+            fArena( NULL ),
+            fChunkNBytes( 0 ),
+            fCurrent( 0 ),
+            fInFlight( 0 ),
+            fNextOffset( 0 )
+    {
+    }
+    MonarchIOReadAhead::~MonarchIOReadAhead()
+    {
+        Close();
+    }
+
+    bool MonarchIOReadAhead::Open( const string& aFilename )
+    {
+        if( fMode != sAccessRead )
+        {
+            return false;
+        }
+        fDescriptor = open( aFilename.c_str(), O_RDONLY );
+#ifdef POSIX_FADV_SEQUENTIAL
+        if( fDescriptor >= 0 )
+        {
+            posix_fadvise( fDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL );
+        }
+#endif
+        fPosition = 0;
+        fDone = false;
+        return fDescriptor >= 0;
+    }
+
+    bool MonarchIOReadAhead::Write( const byte_type*, size_t )
+    {
+        return false;
+    }
+
+    void MonarchIOReadAhead::SetRecordNBytes( size_t aNBytes )
+    {
+        if( fDescriptor < 0 || fEngine != NULL || aNBytes == 0 )
+        {
+            return;
+        }
+
+        size_t tRecords = (sMinChunkNBytes + aNBytes - 1) / aNBytes;
+        fChunkNBytes = tRecords * aNBytes;
+        size_t tBufferNBytes = (fChunkNBytes + sAlignment - 1) / sAlignment * sAlignment;
+        if( posix_memalign( reinterpret_cast< void** >( &fArena ), sAlignment, sDepth * tBufferNBytes ) != 0 )
+        {
+            fArena = NULL;
+            return;
+        }
+        for( unsigned tIndex = 0; tIndex < sDepth; ++tIndex )
+        {
+            fBuffers[ tIndex ] = fArena + tIndex * tBufferNBytes;
+        }
+
+#ifdef Monarch_HAVE_IO_URING
+        MonarchReadAheadURing* tURing = new MonarchReadAheadURing( fDescriptor, fBuffers, sDepth, tBufferNBytes );
+        if( tURing->IsReady() == true )
+        {
+            fEngine = tURing;
+        }
+        else
+        {
+            delete tURing;
+        }
+#endif
+        if( fEngine == NULL )
+        {
+            MonarchReadAheadThread* tThread = new MonarchReadAheadThread( fDescriptor, fBuffers );
+            if( tThread->IsReady() == true )
+            {
+                fEngine = tThread;
+            }
+            else
+            {
+                delete tThread;
+            }
+        }
+
+        if( fEngine == NULL || StartReadAhead() == false )
+        {
+            StopReadAhead();
+            delete fEngine;
+            fEngine = NULL;
+            free( fArena );
+            fArena = NULL;
+        }
+        return;
+    }
+
+    void MonarchIOReadAhead::Submit( unsigned aBuffer )
+    {
+        fChunkOffset[ aBuffer ] = fNextOffset;
+        fChunkSize[ aBuffer ] = 0;
+        fChunkReady[ aBuffer ] = false;
+        fNextOffset += fChunkNBytes;
+        ++fInFlight;
+        if( fEngine->Submit( aBuffer, fChunkOffset[ aBuffer ], fChunkNBytes ) == false )
+        {
+            // leave it to Complete() to read the chunk synchronously
+            --fInFlight;
+            fChunkReady[ aBuffer ] = true;
+            fChunkSize[ aBuffer ] = -2;
+        }
+        return;
+    }
+
+    bool MonarchIOReadAhead::Complete( unsigned aBuffer )
+    {
+        ssize_t tRead = 0;
+        if( fChunkSize[ aBuffer ] != -2 )
+        {
+            tRead = fEngine->Wait( aBuffer );
+            --fInFlight;
+            if( tRead < 0 )
+            {
+                // the ring refused the read (e.g. -EINVAL for a file system it can't read from), so pread gets its own chance
+                tRead = 0;
+            }
+        }
+
+        // a short read that isn't the end of the file, or one that failed in the ring, is finished synchronously
+        while( tRead < (ssize_t)fChunkNBytes )
+        {
+            ssize_t tMore = pread( fDescriptor, fBuffers[ aBuffer ] + tRead, fChunkNBytes - tRead, fChunkOffset[ aBuffer ] + tRead );
+            if( tMore < 0 )
+            {
+                if( errno == EINTR ) continue;
+                fChunkReady[ aBuffer ] = true;
+                fChunkSize[ aBuffer ] = -1;
+                return false;
+            }
+            if( tMore == 0 ) break;
+            tRead += tMore;
+        }
+
+        fChunkReady[ aBuffer ] = true;
+        fChunkSize[ aBuffer ] = tRead;
+        return true;
+    }
+
+    bool MonarchIOReadAhead::StartReadAhead()
+    {
+        fCurrent = 0;
+        fInFlight = 0;
+        fNextOffset = fPosition;
+        for( unsigned tIndex = 0; tIndex < sDepth; ++tIndex )
+        {
+            Submit( tIndex );
+        }
+        return true;
+    }
+
+    void MonarchIOReadAhead::StopReadAhead()
+    {
+        if( fEngine == NULL )
+        {
+            return;
+        }
+        // the buffers can't be reused until the kernel or the thread is done with them
+        for( unsigned tIndex = 0; tIndex < sDepth; ++tIndex )
+        {
+            if( fChunkReady[ tIndex ] == false )
+            {
+                fEngine->Wait( tIndex );
+                --fInFlight;
+                fChunkReady[ tIndex ] = true;
+                fChunkSize[ tIndex ] = 0;
+            }
+        }
+        return;
+    }
+
+    bool MonarchIOReadAhead::ReadDirect( byte_type* anArray, size_t aCount )
+    {
+        while( aCount > 0 )
+        {
+            ssize_t tRead = pread( fDescriptor, anArray, aCount, fPosition );
+            if( tRead < 0 )
+            {
+                if( errno == EINTR ) continue;
+                return false;
+            }
+            if( tRead == 0 )
+            {
+                fDone = true;
+                return false;
+            }
+            anArray += tRead;
+            aCount -= tRead;
+            fPosition += tRead;
+        }
+        return true;
+    }
+
+    bool MonarchIOReadAhead::ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset )
+    {
+        // the chunks in flight belong to the cursor, so this reads the file itself
+        if( fDescriptor < 0 )
+        {
+            return false;
+        }
+        return ReadFully( fDescriptor, anArray, aCount, anOffset );
+    }
+
+    bool MonarchIOReadAhead::Read( byte_type* anArray, size_t aCount )
+    {
+        if( fEngine == NULL )
+        {
+            return ReadDirect( anArray, aCount );
+        }
+
+        while( aCount > 0 )
+        {
+            unsigned tCurrent = fCurrent;
+            if( fChunkReady[ tCurrent ] == false || fChunkSize[ tCurrent ] == -2 )
+            {
+                if( Complete( tCurrent ) == false )
+                {
+                    return false;
+                }
+            }
+            if( fChunkSize[ tCurrent ] < 0 )
+            {
+                return false;
+            }
+
+            off_t tChunkEnd = fChunkOffset[ tCurrent ] + fChunkSize[ tCurrent ];
+            if( fPosition >= tChunkEnd )
+            {
+                if( fChunkSize[ tCurrent ] < (ssize_t)fChunkNBytes )
+                {
+                    fDone = true;
+                    return false;
+                }
+                // this chunk is used up: reuse its buffer for the next read ahead
+                Submit( tCurrent );
+                fCurrent = (tCurrent + 1) % sDepth;
+                continue;
+            }
+
+            size_t tAvailable = tChunkEnd - fPosition;
+            size_t tCopy = aCount < tAvailable ? aCount : tAvailable;
+            memcpy( anArray, fBuffers[ tCurrent ] + (fPosition - fChunkOffset[ tCurrent ]), tCopy );
+            anArray += tCopy;
+            aCount -= tCopy;
+            fPosition += tCopy;
+        }
+        return true;
+    }
+
+    bool MonarchIOReadAhead::Seek( long int aCount )
+    {
+        if( aCount < 0 && -aCount > fPosition )
+        {
+            return false;
+        }
+        fPosition += aCount;
+        fDone = false;
+
+        // outside the prefetched window: start over from the new position
+        if( fEngine != NULL && (fPosition < fChunkOffset[ fCurrent ] || fPosition >= fNextOffset) )
+        {
+            StopReadAhead();
+            StartReadAhead();
+        }
+        return true;
+    }
+
+    bool MonarchIOReadAhead::Done()
+    {
+        return fDone;
+    }
+
+    bool MonarchIOReadAhead::Close()
+    {
+        StopReadAhead();
+        delete fEngine;
+        fEngine = NULL;
+        free( fArena );
+        fArena = NULL;
+
+        if( fDescriptor >= 0 )
+        {
+            int tResult = close( fDescriptor );
+            fDescriptor = -1;
+            return tResult == 0;
+        }
+        return false;
+    }
+
+    bool MonarchIOReadAhead::UsesIOUring() const
+    {
+        return fEngine != NULL && fEngine->IsIOUring();
+    }
+
+}
@@ -0,0 +1,70 @@
+#ifndef MONARCHIOREADAHEAD_HPP_
+#define MONARCHIOREADAHEAD_HPP_
+
+#include "MonarchIO.hpp"
+
+#include <sys/types.h>
+
+namespace monarch
+{
+
+    class MonarchReadAheadEngine;
+
+    // Sequential read-ahead backend (sIOReadAhead), reading only.
+    // Once the record size is known it keeps sDepth reads of whole records in flight ahead of the cursor,
+    // into aligned buffers registered with io_uring; where io_uring is not available
+    // a prefetch thread issues the reads instead. Until then, and after seeking outside the
+    // prefetched window, it reads like the positional backend.
+    class MonarchIOReadAhead :
+        public MonarchIO
+    {
+        public:
+            static const unsigned sDepth = 8;
+            // chunks hold as many whole records as fit in at least this many bytes
+            static const size_t sMinChunkNBytes = 256 * 1024;
+            static const size_t sAlignment = 4096;
+
+        private:
+            int fDescriptor;
+            off_t fPosition;
+            bool fDone;
+
+            MonarchReadAheadEngine* fEngine;
+            byte_type* fArena;
+            byte_type* fBuffers[ sDepth ];
+            size_t fChunkNBytes;
+
+            // the chunk the cursor is in, and the file offset and size of every chunk in flight
+            unsigned fCurrent;
+            unsigned fInFlight;
+            off_t fChunkOffset[ sDepth ];
+            ssize_t fChunkSize[ sDepth ];
+            bool fChunkReady[ sDepth ];
+            off_t fNextOffset;
+
+            bool ReadDirect( byte_type* anArray, size_t aCount );
+            bool StartReadAhead();
+            void StopReadAhead();
+            void Submit( unsigned aBuffer );
+            bool Complete( unsigned aBuffer );
+
+        public:
+            MonarchIOReadAhead( AccessModeType aMode );
+            virtual ~MonarchIOReadAhead();
+
+            virtual bool Open( const string& aFilename );
+            virtual bool Write( const byte_type* anArray, size_t aCount );
+            virtual bool Seek( long int aCount );
+            virtual bool Read( byte_type* anArray, size_t aCount );
+            virtual bool ReadAt( byte_type* anArray, size_t aCount, uint64_t anOffset );
+            virtual void SetRecordNBytes( size_t aNBytes );
+            virtual bool Done();
+            virtual bool Close();
+
+            // true if the reads are issued through io_uring rather than the prefetch thread
+            bool UsesIOUring() const;
+    };
+
+}
+
+#endif
@@ -43,36 +43,67 @@ int main( const int argc, const char** argv )
         return 0;
     }
 
-    unsigned int tRecordCount = 0;
-    unsigned int tAcquisiontCount = 0;
-    const MonarchRecordBytes* tReadRecord;
-    if( tReadHeader->GetAcquisitionMode() == 1 /* the FormatMode is ignored for single-channel data */ )
-    {
-        tReadRecord = tReadTest->GetRecordSeparateOne();
-    }
-    else if( tReadHeader->GetAcquisitionMode() == 2 && tReadHeader->GetFormatMode() == sFormatMultiSeparate )
+    // a file that was closed properly carries its own summary
+    const MonarchFooter* tReadFooter = tReadTest->GetFooter();
+    if( tReadFooter != NULL )
     {
-        tReadRecord = tReadTest->GetRecordSeparateOne();
-    }
-    else if( tReadHeader->GetAcquisitionMode() == 2 && tReadHeader->GetFormatMode() == sFormatMultiInterleaved )
-    {
-        tReadRecord = tReadTest->GetRecordInterleaved();
+        MINFO( mlog, *tReadFooter );
+        MINFO( mlog, "record count <" << tReadFooter->GetNRecords() << ">" );
+        MINFO( mlog, "acquisition count <" << tReadFooter->GetNAcquisitions() << ">" );
+
+        tReadTest->Close();
+        delete tReadTest;
+        return 0;
     }
-    else
+
+    // without a footer, the records of a file that is not stored in blocks are counted from its size,
+    // and the acquisitions from the first and last records; only their ids are read, not their samples
+    if( tReadHeader->GetCompression() == sCompressionNone && tReadHeader->GetBlockIndex() == false && tReadHeader->GetChecksums() == false )
     {
-        MERROR( mlog, "Unable to read a header with acquisition mode <" << tReadHeader->GetAcquisitionMode() << "> and format mode <" << tReadHeader->GetFormatMode() << ">" );
-        return -1;
+        try
+        {
+            unsigned long long tNRecords = tReadTest->GetNRecords();
+            unsigned long long tNAcquisitions = 0;
+            MonarchRecordMetadata tFirst;
+            MonarchRecordMetadata tLast;
+            if( tNRecords > 0 && tReadTest->ReadMetadata( &tFirst, 0, 1 ) == 1 && tReadTest->ReadMetadata( &tLast, tNRecords - 1, 1 ) == 1 )
+            {
+                tNAcquisitions = tLast.fAcquisitionIds[ 0 ] - tFirst.fAcquisitionIds[ 0 ] + 1;
+            }
+            MINFO( mlog, "record count <" << tNRecords << ">" );
+            MINFO( mlog, "acquisition count <" << tNAcquisitions << ">" );
+        }
+        catch (MonarchException& e)
+        {
+            MWARN( mlog, "Something went wrong during the reading of records!" << "\n\t" << e.what() );
+        }
+
+        tReadTest->Close();
+        delete tReadTest;
+        return 0;
     }
+
+    unsigned int tRecordCount = 0;
+    unsigned int tAcquisiontCount = 0;
     try
     {
-        while( tReadTest->ReadRecord() != false )
+        // a window of records at a time, so a long run does not need more memory than a short one
+        const uint64_t tWindowNRecords = 4096;
+        MonarchRecordMetadata tMetadata;
+        while( tReadTest->ReadMetadata( &tMetadata, tRecordCount, tWindowNRecords ) > 0 )
         {
-            tRecordCount = tRecordCount + 1;
-            if( tReadRecord->fAcquisitionId == tAcquisiontCount )
+            for( size_t tIndex = 0; tIndex < tMetadata.fAcquisitionIds.size(); ++tIndex )
+            {
+                tRecordCount = tRecordCount + 1;
+                if( tMetadata.fAcquisitionIds[ tIndex ] == tAcquisiontCount )
+                {
+                    tAcquisiontCount = tAcquisiontCount + 1;
+                }
+            }
+            if( tMetadata.fAcquisitionIds.size() < tWindowNRecords )
             {
-                tAcquisiontCount = tAcquisiontCount + 1;
+                break;
             }
-            //cout << "  record " << tRecordCount << ": time offset: " << tReadRecord->fTime << " ns" << endl;
         }
     }
     catch (MonarchException& e)
@@ -0,0 +1,118 @@
+#include "MonarchManifest.hpp"
+#include "MonarchManifest.pb.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace monarch
+{
+
+    const char MonarchManifest::sManifestMagic[ 8 ] = { 'M', 'O', 'N', 'A', 'R', 'C', 'H', 'S' };
+
+    MonarchManifest::MonarchManifest() :
+            fProtobufManifest( new Protobuf::MonarchManifest() )
+    {
+        fProtobufManifest->set_stripenrecords( 1 );
+    }
+    MonarchManifest::~MonarchManifest()
+    {
+        delete fProtobufManifest;
+    }
+
+    bool MonarchManifest::MarshalToFile( const string& aFilename ) const
+    {
+        size_t tNBytes = fProtobufManifest->ByteSizeLong();
+        std::vector< char > tBuffer( tNBytes + 1 );
+        if( fProtobufManifest->SerializeToArray( &tBuffer[ 0 ], tNBytes ) == false )
+        {
+            return false;
+        }
+
+        FILE* tFile = fopen( aFilename.c_str(), "wb" );
+        if( tFile == NULL )
+        {
+            return false;
+        }
+        bool tWritten = fwrite( sManifestMagic, sizeof(sManifestMagic), 1, tFile ) == 1 && fwrite( &tBuffer[ 0 ], 1, tNBytes, tFile ) == (size_t) tNBytes;
+        if( fclose( tFile ) != 0 )
+        {
+            tWritten = false;
+        }
+        return tWritten;
+    }
+
+    bool MonarchManifest::DemarshalFromFile( const string& aFilename )
+    {
+        FILE* tFile = fopen( aFilename.c_str(), "rb" );
+        if( tFile == NULL )
+        {
+            return false;
+        }
+
+        bool tFound = false;
+        char tMagic[ sizeof(sManifestMagic) ];
+        if( fread( tMagic, sizeof(tMagic), 1, tFile ) == 1 && memcmp( tMagic, sManifestMagic, sizeof(tMagic) ) == 0 )
+        {
+            std::vector< char > tBuffer;
+            char tChunk[ 4096 ];
+            size_t tRead;
+            while( (tRead = fread( tChunk, 1, sizeof(tChunk), tFile )) > 0 )
+            {
+                tBuffer.insert( tBuffer.end(), tChunk, tChunk + tRead );
+            }
+            tBuffer.push_back( 0 );
+            tFound = ferror( tFile ) == 0 && fProtobufManifest->ParseFromArray( &tBuffer[ 0 ], tBuffer.size() - 1 ) == true;
+        }
+        fclose( tFile );
+        return tFound;
+    }
+
+    void MonarchManifest::AddStripe( const string& aFilename )
+    {
+        fProtobufManifest->add_stripes( aFilename );
+        return;
+    }
+    unsigned MonarchManifest::GetNStripes() const
+    {
+        return fProtobufManifest->stripes_size();
+    }
+    const string& MonarchManifest::GetStripe( unsigned aStripe ) const
+    {
+        return fProtobufManifest->stripes( aStripe );
+    }
+
+    void MonarchManifest::SetStripeNRecords( unsigned aNRecords )
+    {
+        fProtobufManifest->set_stripenrecords( aNRecords );
+        return;
+    }
+    unsigned MonarchManifest::GetStripeNRecords() const
+    {
+        return fProtobufManifest->stripenrecords();
+    }
+
+    void MonarchManifest::SetNRecords( uint64_t aNRecords )
+    {
+        fProtobufManifest->set_nrecords( aNRecords );
+        return;
+    }
+    uint64_t MonarchManifest::GetNRecords() const
+    {
+        return fProtobufManifest->nrecords();
+    }
+
+}
+
+std::ostream& operator<<( std::ostream& out, const monarch::MonarchManifest& mft )
+{
+    out << "Monarch Manifest Content: " << "\n";
+    out << "\tStripes: " << mft.GetNStripes() << "\n";
+    for( unsigned tStripe = 0; tStripe < mft.GetNStripes(); ++tStripe )
+    {
+        out << "\t\t" << mft.GetStripe( tStripe ) << "\n";
+    }
+    out << "\tRecords per Turn: " << mft.GetStripeNRecords() << "\n";
+    out << "\tRecords: " << mft.GetNRecords() << "\n";
+    return out;
+}
@@ -0,0 +1,58 @@
+#ifndef MONARCHMANIFEST_HPP_
+#define MONARCHMANIFEST_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <string>
+using std::string;
+
+namespace Protobuf
+{
+    class MonarchManifest;
+}
+
+namespace monarch
+{
+
+    //the manifest of a run that is striped over several files (see MonarchStripedWriter): the files, and how the records
+    //were dealt out to them. the manifest file holds the 8 bytes of sManifestMagic followed by the marshalled manifest.
+    class MonarchManifest
+    {
+        private:
+            mutable Protobuf::MonarchManifest* fProtobufManifest;
+
+        public:
+            MonarchManifest();
+            ~MonarchManifest();
+
+            static const char sManifestMagic[ 8 ];
+
+            //marshal the manifest to the file aFilename, replacing it
+            bool MarshalToFile( const string& aFilename ) const;
+
+            //demarshal the manifest from the file aFilename.
+            //returns false if the file is not a manifest.
+            bool DemarshalFromFile( const string& aFilename );
+
+            //access methods
+
+            // Files of the stripes, in the order the records are dealt out to them
+            void AddStripe( const string& aFilename );
+            unsigned GetNStripes() const;
+            const string& GetStripe( unsigned aStripe ) const;
+
+            // Number of records that go to a stripe before the next one gets its turn
+            void SetStripeNRecords( unsigned aNRecords );
+            unsigned GetStripeNRecords() const;
+
+            // Number of records in the run; 0 until the run is closed
+            void SetNRecords( uint64_t aNRecords );
+            uint64_t GetNRecords() const;
+    };
+
+}
+
+// Pretty printing method
+std::ostream& operator<<( std::ostream& out, const monarch::MonarchManifest& mft );
+
+#endif
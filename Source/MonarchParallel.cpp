@@ -0,0 +1,360 @@
+#include "MonarchParallel.hpp"
+
+#include "MonarchException.hpp"
+
+#include <unistd.h>
+
+#include <sstream>
+using std::stringstream;
+
+namespace monarch
+{
+
+    MonarchRecordTask::MonarchRecordTask()
+    {
+    }
+    MonarchRecordTask::~MonarchRecordTask()
+    {
+    }
+
+    void MonarchRecordTask::Reduce( uint64_t )
+    {
+        return;
+    }
+
+    MonarchParallel::MonarchParallel( const Monarch* aMonarch, unsigned aNThreads ) :
+            fMonarch( aMonarch ),
+            fNThreads( aNThreads ),
+            fChunkNRecords( 0 ),
+            fInterfaceSet( false ),
+            fInterface( sInterfaceSeparate ),
+            fChannelMaskSet( false ),
+            fChannelMask( sChannelBoth ),
+            fWorkers(),
+            fTask( NULL ),
+            fNRecords( 0 ),
+            fNChunks( 0 ),
+            fNRecordsPerChunk( 0 ),
+            fChunksDone(),
+            fNextReduce( 0 ),
+            fReducing( false ),
+            fError(),
+            fStopping( 0 )
+    {
+        if( fNThreads == 0 )
+        {
+            long tNCores = sysconf( _SC_NPROCESSORS_ONLN );
+            fNThreads = tNCores > 0 ? (unsigned) tNCores : 1;
+        }
+        pthread_mutex_init( &fReduceMutex, NULL );
+        pthread_mutex_init( &fErrorMutex, NULL );
+    }
+    MonarchParallel::~MonarchParallel()
+    {
+        pthread_mutex_destroy( &fErrorMutex );
+        pthread_mutex_destroy( &fReduceMutex );
+    }
+
+    void MonarchParallel::SetChunkNRecords( uint64_t aNRecords )
+    {
+        fChunkNRecords = aNRecords;
+        return;
+    }
+
+    void MonarchParallel::SetInterface( InterfaceModeType aMode )
+    {
+        fInterfaceSet = true;
+        fInterface = aMode;
+        return;
+    }
+
+    void MonarchParallel::SetChannelMask( ChannelMaskType aMask )
+    {
+        fChannelMaskSet = true;
+        fChannelMask = aMask;
+        return;
+    }
+
+    uint64_t MonarchParallel::ChunkNRecords( uint64_t aNRecords ) const
+    {
+        if( fChunkNRecords != 0 )
+        {
+            return fChunkNRecords;
+        }
+
+        // the stride only sets the size of the chunks, so without a footer the records of the header are close enough
+        const MonarchHeader* tHeader = fMonarch->GetHeader();
+        uint64_t tStrideNBytes = tHeader->GetAcquisitionMode() * tHeader->GetRecordSize() * tHeader->GetDataTypeSize();
+        if( fMonarch->GetFooter() != NULL && fMonarch->GetFooter()->GetRecordNBytes() != 0 )
+        {
+            tStrideNBytes = fMonarch->GetFooter()->GetRecordNBytes();
+        }
+        if( tStrideNBytes == 0 )
+        {
+            tStrideNBytes = 1;
+        }
+
+        // a block is decompressed by every worker that reads from it, so chunks are made of whole blocks
+        uint64_t tBlockNRecords = tHeader->GetBlockSize();
+        if( tBlockNRecords == 0 )
+        {
+            tBlockNRecords = (1024 * 1024 + tStrideNBytes - 1) / tStrideNBytes;
+        }
+        uint64_t tNBlocks = (4 * 1024 * 1024 + tBlockNRecords * tStrideNBytes - 1) / (tBlockNRecords * tStrideNBytes);
+        uint64_t tNBlocksForShare = (aNRecords + 4 * fNThreads * tBlockNRecords - 1) / (4 * fNThreads * tBlockNRecords);
+        if( tNBlocksForShare < tNBlocks )
+        {
+            tNBlocks = tNBlocksForShare > 0 ? tNBlocksForShare : 1;
+        }
+        return tNBlocks * tBlockNRecords;
+    }
+
+    uint64_t MonarchParallel::GetNChunks() const
+    {
+        uint64_t tNRecords = fMonarch->GetNRecords();
+        uint64_t tChunkNRecords = ChunkNRecords( tNRecords );
+        return (tNRecords + tChunkNRecords - 1) / tChunkNRecords;
+    }
+
+    uint64_t MonarchParallel::ForEachRecord( MonarchRecordTask& aTask )
+    {
+        fTask = &aTask;
+        fNRecords = fMonarch->GetNRecords();
+        fNRecordsPerChunk = ChunkNRecords( fNRecords );
+        fNChunks = (fNRecords + fNRecordsPerChunk - 1) / fNRecordsPerChunk;
+        fChunksDone.assign( fNChunks, false );
+        fNextReduce = 0;
+        fReducing = false;
+        fError.clear();
+        fStopping = 0;
+        if( fNChunks == 0 )
+        {
+            return 0;
+        }
+
+        // each worker starts with a run of consecutive chunks, so the file is read in a few long sweeps
+        unsigned tNWorkers = fNChunks < fNThreads ? (unsigned) fNChunks : fNThreads;
+        fWorkers.clear();
+        fWorkers.resize( tNWorkers );
+        for( unsigned tIndex = 0; tIndex < tNWorkers; ++tIndex )
+        {
+            Worker& tWorker = fWorkers[ tIndex ];
+            tWorker.fParallel = this;
+            tWorker.fIndex = tIndex;
+            tWorker.fNext = fNChunks * tIndex / tNWorkers;
+            tWorker.fEnd = fNChunks * (tIndex + 1) / tNWorkers;
+            tWorker.fNProcessed = 0;
+            tWorker.fStarted = false;
+            pthread_mutex_init( &tWorker.fMutex, NULL );
+        }
+
+        // the first worker runs on this thread; the chunks of a thread that could not be started are taken by the others
+        for( unsigned tIndex = 1; tIndex < tNWorkers; ++tIndex )
+        {
+            fWorkers[ tIndex ].fStarted = pthread_create( &fWorkers[ tIndex ].fThread, NULL, &MonarchParallel::Run, &fWorkers[ tIndex ] ) == 0;
+        }
+        Execute( fWorkers[ 0 ] );
+        uint64_t tNProcessed = fWorkers[ 0 ].fNProcessed;
+        for( unsigned tIndex = 1; tIndex < tNWorkers; ++tIndex )
+        {
+            if( fWorkers[ tIndex ].fStarted == true )
+            {
+                pthread_join( fWorkers[ tIndex ].fThread, NULL );
+            }
+            tNProcessed += fWorkers[ tIndex ].fNProcessed;
+        }
+        for( unsigned tIndex = 0; tIndex < tNWorkers; ++tIndex )
+        {
+            pthread_mutex_destroy( &fWorkers[ tIndex ].fMutex );
+        }
+        fWorkers.clear();
+        fTask = NULL;
+
+        if( fError.empty() == false )
+        {
+            throw MonarchException() << fError;
+        }
+        return tNProcessed;
+    }
+
+    void* MonarchParallel::Run( void* anArgument )
+    {
+        Worker* tWorker = static_cast< Worker* >( anArgument );
+        tWorker->fParallel->Execute( *tWorker );
+        return NULL;
+    }
+
+    void MonarchParallel::Execute( Worker& aWorker )
+    {
+        MonarchCursor* tCursor = NULL;
+        try
+        {
+            tCursor = new MonarchCursor( fMonarch );
+            if( fInterfaceSet == true )
+            {
+                tCursor->SetInterface( fInterface );
+            }
+            if( fChannelMaskSet == true )
+            {
+                tCursor->SetChannelMask( fChannelMask );
+            }
+        }
+        catch( MonarchException& e )
+        {
+            delete tCursor;
+            Fail( e.what() );
+            return;
+        }
+
+        uint64_t tChunk;
+        while( NextChunk( aWorker, tChunk ) == true )
+        {
+            uint64_t tFirst = tChunk * fNRecordsPerChunk;
+            uint64_t tLast = tFirst + fNRecordsPerChunk < fNRecords ? tFirst + fNRecordsPerChunk : fNRecords;
+            tCursor->SetRecordIndex( tFirst );
+            for( uint64_t tIndex = tFirst; tIndex < tLast; ++tIndex )
+            {
+                if( __atomic_load_n( &fStopping, __ATOMIC_RELAXED ) != 0 )
+                {
+                    break;
+                }
+                try
+                {
+                    if( tCursor->ReadRecord() == false )
+                    {
+                        stringstream tError;
+                        tError << "could not read record <" << tIndex << ">";
+                        Fail( tError.str() );
+                        break;
+                    }
+                    fTask->Process( *tCursor, tIndex, tChunk );
+                }
+                catch( MonarchException& e )
+                {
+                    Fail( e.what() );
+                    break;
+                }
+                catch( ... )
+                {
+                    stringstream tError;
+                    tError << "an exception was thrown while processing record <" << tIndex << ">";
+                    Fail( tError.str() );
+                    break;
+                }
+                ++aWorker.fNProcessed;
+            }
+            if( __atomic_load_n( &fStopping, __ATOMIC_RELAXED ) != 0 )
+            {
+                break;
+            }
+            FinishChunk( tChunk );
+        }
+
+        delete tCursor;
+        return;
+    }
+
+    bool MonarchParallel::NextChunk( Worker& aWorker, uint64_t& aChunk )
+    {
+        pthread_mutex_lock( &aWorker.fMutex );
+        if( aWorker.fNext < aWorker.fEnd )
+        {
+            aChunk = aWorker.fNext++;
+            pthread_mutex_unlock( &aWorker.fMutex );
+            return true;
+        }
+        pthread_mutex_unlock( &aWorker.fMutex );
+
+        // steal the back half of the worker with the most chunks left, so the two of them sweep on in opposite halves
+        while( __atomic_load_n( &fStopping, __ATOMIC_RELAXED ) == 0 )
+        {
+            Worker* tVictim = NULL;
+            uint64_t tMost = 0;
+            for( unsigned tOffset = 1; tOffset < fWorkers.size(); ++tOffset )
+            {
+                Worker& tOther = fWorkers[ (aWorker.fIndex + tOffset) % fWorkers.size() ];
+                pthread_mutex_lock( &tOther.fMutex );
+                uint64_t tLeft = tOther.fEnd - tOther.fNext;
+                pthread_mutex_unlock( &tOther.fMutex );
+                if( tLeft > tMost )
+                {
+                    tMost = tLeft;
+                    tVictim = &tOther;
+                }
+            }
+            if( tVictim == NULL )
+            {
+                return false;
+            }
+
+            pthread_mutex_lock( &tVictim->fMutex );
+            uint64_t tLeft = tVictim->fEnd - tVictim->fNext;
+            if( tLeft == 0 )
+            {
+                // taken by its owner or another thief in the meantime
+                pthread_mutex_unlock( &tVictim->fMutex );
+                continue;
+            }
+            uint64_t tEnd = tVictim->fEnd;
+            tVictim->fEnd -= tLeft / 2;
+            uint64_t tStart = tLeft / 2 > 0 ? tVictim->fEnd : --tVictim->fEnd;
+            pthread_mutex_unlock( &tVictim->fMutex );
+
+            pthread_mutex_lock( &aWorker.fMutex );
+            aChunk = tStart;
+            aWorker.fNext = tStart + 1;
+            aWorker.fEnd = tEnd;
+            pthread_mutex_unlock( &aWorker.fMutex );
+            return true;
+        }
+        return false;
+    }
+
+    void MonarchParallel::FinishChunk( uint64_t aChunk )
+    {
+        pthread_mutex_lock( &fReduceMutex );
+        fChunksDone[ aChunk ] = true;
+        // one thread reduces at a time; chunks that finish meanwhile are picked up by its next pass
+        while( fReducing == false && fNextReduce < fNChunks && fChunksDone[ fNextReduce ] == true )
+        {
+            uint64_t tChunk = fNextReduce++;
+            fReducing = true;
+            pthread_mutex_unlock( &fReduceMutex );
+            try
+            {
+                fTask->Reduce( tChunk );
+            }
+            catch( MonarchException& e )
+            {
+                Fail( e.what() );
+            }
+            catch( ... )
+            {
+                stringstream tError;
+                tError << "an exception was thrown while reducing chunk <" << tChunk << ">";
+                Fail( tError.str() );
+            }
+            pthread_mutex_lock( &fReduceMutex );
+            fReducing = false;
+            if( __atomic_load_n( &fStopping, __ATOMIC_RELAXED ) != 0 )
+            {
+                break;
+            }
+        }
+        pthread_mutex_unlock( &fReduceMutex );
+        return;
+    }
+
+    void MonarchParallel::Fail( const string& anError )
+    {
+        pthread_mutex_lock( &fErrorMutex );
+        if( fError.empty() == true )
+        {
+            fError = anError;
+        }
+        __atomic_store_n( &fStopping, 1, __ATOMIC_RELAXED );
+        pthread_mutex_unlock( &fErrorMutex );
+        return;
+    }
+
+}
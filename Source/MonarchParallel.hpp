@@ -0,0 +1,117 @@
+#ifndef MONARCHPARALLEL_HPP_
+#define MONARCHPARALLEL_HPP_
+
+#include "MonarchCursor.hpp"
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+using std::string;
+
+namespace monarch
+{
+
+    //the work MonarchParallel does for every record of a file
+    class MonarchRecordTask
+    {
+        public:
+            MonarchRecordTask();
+            virtual ~MonarchRecordTask();
+
+            //called on a worker thread for record anIndex, which aCursor holds; anIndex belongs to chunk aChunk.
+            //the records of a chunk are processed in order on one thread, and different chunks on different threads at once,
+            //so anything shared between chunks has to be kept per chunk or guarded.
+            virtual void Process( const MonarchCursor& aCursor, uint64_t anIndex, uint64_t aChunk ) = 0;
+
+            //called once for every chunk, in chunk order and on one thread at a time, once the chunk and all chunks
+            //before it have been processed, so partial results kept per chunk can be combined in file order.
+            //the default does nothing.
+            virtual void Reduce( uint64_t aChunk );
+    };
+
+    //runs a MonarchRecordTask over every record of a monarch that has read its header, on several threads.
+    //the records are split into chunks of consecutive records, and each worker starts with an even share of the chunks
+    //and reads them through a MonarchCursor of its own. a worker that runs out takes half of the chunks another worker
+    //has not started yet, so a slow range does not hold the others up.
+    //the monarch must not be read with ReadRecord while ForEachRecord runs.
+    class MonarchParallel
+    {
+        public:
+            //aNThreads workers; 0 uses one per core.
+            MonarchParallel( const Monarch* aMonarch, unsigned aNThreads = 0 );
+            ~MonarchParallel();
+
+            //records per chunk; 0, the default, is 4 MB worth, lined up with the blocks of a block-structured file
+            //and made smaller where that leaves fewer than 4 chunks per worker.
+            void SetChunkNRecords( uint64_t aNRecords );
+
+            //number of chunks of the file, for sizing per-chunk results before ForEachRecord.
+            //an exception is thrown if the records cannot be counted (see Monarch::GetNRecords).
+            uint64_t GetNChunks() const;
+
+            //set the interface type and the channel mask of the workers' cursors (see Monarch); the cursors keep their defaults for those not set.
+            void SetInterface( InterfaceModeType aMode );
+            void SetChannelMask( ChannelMaskType aMask );
+
+            //process every record with aTask and return the number of records processed.
+            //if a record cannot be read or aTask throws, the workers stop after their current record and an exception is thrown here.
+            uint64_t ForEachRecord( MonarchRecordTask& aTask );
+
+        private:
+            const Monarch* fMonarch;
+            unsigned fNThreads;
+            uint64_t fChunkNRecords;
+            bool fInterfaceSet;
+            InterfaceModeType fInterface;
+            bool fChannelMaskSet;
+            ChannelMaskType fChannelMask;
+
+            //the chunks a worker has not started yet; others take from the back
+            struct Worker
+            {
+                    MonarchParallel* fParallel;
+                    unsigned fIndex;
+                    uint64_t fNext;
+                    uint64_t fEnd;
+                    uint64_t fNProcessed;
+                    pthread_mutex_t fMutex;
+                    pthread_t fThread;
+                    bool fStarted;
+            };
+            std::vector< Worker > fWorkers;
+
+            MonarchRecordTask* fTask;
+            uint64_t fNRecords;
+            uint64_t fNChunks;
+            uint64_t fNRecordsPerChunk;
+
+            //chunks processed, and the next one to reduce
+            std::vector< bool > fChunksDone;
+            uint64_t fNextReduce;
+            bool fReducing;
+            pthread_mutex_t fReduceMutex;
+
+            //the first error of a worker; the others stop when one is set
+            string fError;
+            uint32_t fStopping;
+            pthread_mutex_t fErrorMutex;
+
+            //records per chunk for a file of aNRecords records
+            uint64_t ChunkNRecords( uint64_t aNRecords ) const;
+
+            static void* Run( void* anArgument );
+            void Execute( Worker& aWorker );
+
+            //take the next chunk of aWorker, or half of another worker's chunks; false when none are left
+            bool NextChunk( Worker& aWorker, uint64_t& aChunk );
+
+            //mark aChunk processed and reduce the chunks that are ready
+            void FinishChunk( uint64_t aChunk );
+
+            void Fail( const string& anError );
+    };
+
+}
+
+#endif
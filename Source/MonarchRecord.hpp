@@ -4,6 +4,8 @@
 #include "MonarchException.hpp"
 #include "MonarchTypes.hpp"
 
+#include <vector>
+
 namespace monarch
 {
     template< typename DataType >
@@ -17,6 +19,14 @@ namespace monarch
 
     typedef MonarchRecord< byte_type > MonarchRecordBytes;
 
+    //the fields in front of the samples of a run of records, one array per field (see Monarch::ReadMetadata)
+    struct MonarchRecordMetadata
+    {
+            std::vector< AcquisitionIdType > fAcquisitionIds;
+            std::vector< RecordIdType > fRecordIds;
+            std::vector< TimeType > fTimes;
+    };
+
     template< typename ReturnType >
     class MonarchRecordDataInterface
     {
@@ -35,6 +45,18 @@ namespace monarch
                 return (this->*fArrayFcn)( index );
             }
 
+            //convert the first aSize samples to XArrayType (uint16_t, int32_t, float, double, ...) and store them in anArray.
+            //the data type size is looked at once per call rather than once per sample, so the copy loops can be vectorized.
+            template< typename XArrayType >
+            void CopyTo( XArrayType* anArray, unsigned aSize ) const
+            {
+                if( fDataTypeSize == 1 ) Convert( fByteData, anArray, aSize );
+                else if( fDataTypeSize == 2 ) Convert( fTwoBytesData, anArray, aSize );
+                else if( fDataTypeSize == 4 ) Convert( fFourBytesData, anArray, aSize );
+                else Convert( fEightBytesData, anArray, aSize );
+                return;
+            }
+
             void SetDataTypeSize( unsigned aDataTypeSize )
             {
                 if( aDataTypeSize == 1 ) fArrayFcn = &MonarchRecordDataInterface< ReturnType >::at_1_byte;
@@ -45,6 +67,7 @@ namespace monarch
                 {
                     throw MonarchException() << "unable to make a record data interface with data type size " << aDataTypeSize;
                 }
+                fDataTypeSize = aDataTypeSize;
                 return;
             }
 
@@ -74,7 +97,22 @@ namespace monarch
                 return fEightBytesData[ index ];
             }
 
+            template< typename XSourceType, typename XArrayType >
+#ifdef __GNUG__
+            static void Convert( const XSourceType* __restrict__ aSource, XArrayType* __restrict__ anArray, unsigned aSize )
+#else
+            static void Convert( const XSourceType* aSource, XArrayType* anArray, unsigned aSize )
+#endif
+            {
+                for( unsigned tIndex = 0; tIndex < aSize; tIndex++ )
+                {
+                    anArray[ tIndex ] = static_cast< XArrayType >( aSource[ tIndex ] );
+                }
+                return;
+            }
+
             ReturnType (MonarchRecordDataInterface::*fArrayFcn)( unsigned ) const;
+            unsigned fDataTypeSize;
 
             union
             {
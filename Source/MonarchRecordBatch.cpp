@@ -0,0 +1,67 @@
+#include "MonarchRecordBatch.hpp"
+
+#include "MonarchException.hpp"
+
+#include <cstdlib>
+
+namespace monarch
+{
+
+    MonarchRecordBatch::MonarchRecordBatch() :
+            fBuffer( NULL ),
+            fNBytes( 0 ),
+            fOwned( true ),
+            fInterleaved(),
+            fSeparateOne(),
+            fSeparateTwo()
+    {
+    }
+    MonarchRecordBatch::MonarchRecordBatch( byte_type* aBuffer, size_t aNBytes ) :
+            fBuffer( aBuffer ),
+            fNBytes( aNBytes ),
+            fOwned( false ),
+            fInterleaved(),
+            fSeparateOne(),
+            fSeparateTwo()
+    {
+    }
+    MonarchRecordBatch::~MonarchRecordBatch()
+    {
+        if( fOwned == true )
+        {
+            free( fBuffer );
+        }
+    }
+
+    void MonarchRecordBatch::Reset( size_t aNBytes, size_t anAlignment )
+    {
+        fInterleaved.clear();
+        fSeparateOne.clear();
+        fSeparateTwo.clear();
+
+        if( fOwned == false )
+        {
+            if( fNBytes < aNBytes )
+            {
+                throw MonarchException() << "the batch buffer of <" << fNBytes << "> bytes is too small for <" << aNBytes << "> bytes";
+            }
+            return;
+        }
+        if( fNBytes >= aNBytes && ((size_t) fBuffer & (anAlignment - 1)) == 0 )
+        {
+            return;
+        }
+        free( fBuffer );
+        fBuffer = NULL;
+        fNBytes = 0;
+        void* tBuffer = NULL;
+        if( posix_memalign( &tBuffer, anAlignment < sizeof(void*) ? sizeof(void*) : anAlignment, aNBytes ) != 0 )
+        {
+            throw MonarchException() << "could not allocate <" << aNBytes << "> bytes for a batch of records";
+        }
+        fBuffer = static_cast< byte_type* >( tBuffer );
+        fNBytes = aNBytes;
+        return;
+    }
+
+}
@@ -0,0 +1,70 @@
+#ifndef MONARCHRECORDBATCH_HPP_
+#define MONARCHRECORDBATCH_HPP_
+
+#include "MonarchRecord.hpp"
+
+#include <vector>
+
+namespace monarch
+{
+
+    //records read together by Monarch::ReadRecords, in one contiguous block of memory.
+    //the block belongs to the batch and grows as needed, or is a buffer the caller hands in (see Monarch::GetBatchNBytes).
+    //for a mapped file, records that need no conversion point straight into the mapping instead.
+    //the records stay valid until the next ReadRecords with this batch.
+    class MonarchRecordBatch
+    {
+        public:
+            MonarchRecordBatch();
+            //use the aNBytes bytes at aBuffer, which stay the caller's, for the records.
+            MonarchRecordBatch( byte_type* aBuffer, size_t aNBytes );
+            ~MonarchRecordBatch();
+
+            //number of records in the batch
+            size_t GetNRecords() const;
+
+            //get the pointers to record anIndex of the batch, for the interface the monarch was set to.
+            //the records of the other interface, and of a channel the channel mask leaves out, are NULL.
+            const MonarchRecordBytes* GetRecordInterleaved( size_t anIndex ) const;
+            const MonarchRecordBytes* GetRecordSeparateOne( size_t anIndex ) const;
+            const MonarchRecordBytes* GetRecordSeparateTwo( size_t anIndex ) const;
+
+        private:
+            friend class Monarch;
+
+            MonarchRecordBatch( const MonarchRecordBatch& );
+            MonarchRecordBatch& operator=( const MonarchRecordBatch& );
+
+            byte_type* fBuffer;
+            size_t fNBytes;
+            bool fOwned;
+
+            std::vector< const MonarchRecordBytes* > fInterleaved;
+            std::vector< const MonarchRecordBytes* > fSeparateOne;
+            std::vector< const MonarchRecordBytes* > fSeparateTwo;
+
+            //empty the batch and make room for aNBytes bytes starting on an anAlignment-byte boundary;
+            //an exception is thrown if the caller's buffer is too small
+            void Reset( size_t aNBytes, size_t anAlignment );
+    };
+
+    inline size_t MonarchRecordBatch::GetNRecords() const
+    {
+        return fSeparateOne.size();
+    }
+    inline const MonarchRecordBytes* MonarchRecordBatch::GetRecordInterleaved( size_t anIndex ) const
+    {
+        return fInterleaved[ anIndex ];
+    }
+    inline const MonarchRecordBytes* MonarchRecordBatch::GetRecordSeparateOne( size_t anIndex ) const
+    {
+        return fSeparateOne[ anIndex ];
+    }
+    inline const MonarchRecordBytes* MonarchRecordBatch::GetRecordSeparateTwo( size_t anIndex ) const
+    {
+        return fSeparateTwo[ anIndex ];
+    }
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "MonarchRecordPool.hpp"
+
+#include <time.h>
+
+namespace monarch
+{
+
+    //record buffers in the arena start on cache-line boundaries
+    static const size_t sSlotAlignment = 64;
+
+    static size_t AlignedSize( size_t aNBytes, size_t anAlignment )
+    {
+        return (aNBytes + anAlignment - 1) / anAlignment * anAlignment;
+    }
+
+    static uint64_t Now()
+    {
+        timespec tTime;
+        clock_gettime( CLOCK_MONOTONIC, &tTime );
+        return (uint64_t)tTime.tv_sec * 1000000000ULL + tTime.tv_nsec;
+    }
+
+    MonarchRecordPool::MonarchRecordPool( unsigned aNSlots, size_t anInterleavedNBytes, size_t aSeparateNBytes, bool aTwoChannels, size_t anAlignment ) :
+            fNSlots( aNSlots < 1 ? 1 : aNSlots ),
+            fSlots( NULL ),
+            fArena( NULL ),
+            fFree( fNSlots ),
+            fHeld( 0 ),
+            fStalls( 0 ),
+            fStallTime( 0 )
+    {
+        size_t tAlignment = anAlignment > sSlotAlignment ? anAlignment : sSlotAlignment;
+        size_t tInterleavedNBytes = AlignedSize( anInterleavedNBytes, tAlignment );
+        size_t tSeparateNBytes = AlignedSize( aSeparateNBytes, tAlignment );
+        size_t tSlotNBytes = tInterleavedNBytes + (aTwoChannels ? 2 : 1) * tSeparateNBytes;
+
+        fArena = new byte_type[ fNSlots * tSlotNBytes + tAlignment ]();
+        byte_type* tCursor = fArena + (tAlignment - (size_t)fArena % tAlignment) % tAlignment;
+
+        fSlots = new MonarchRecordSlot[ fNSlots ];
+        for( unsigned tIndex = 0; tIndex < fNSlots; ++tIndex )
+        {
+            MonarchRecordSlot& tSlot = fSlots[ tIndex ];
+            tSlot.fInterleavedBytes = tCursor;
+            tCursor += tInterleavedNBytes;
+            tSlot.fSeparateOneBytes = tCursor;
+            tCursor += tSeparateNBytes;
+            tSlot.fSeparateTwoBytes = NULL;
+            if( aTwoChannels == true )
+            {
+                tSlot.fSeparateTwoBytes = tCursor;
+                tCursor += tSeparateNBytes;
+            }
+            tSlot.fNSegments = 0;
+
+            new ( tSlot.fInterleavedBytes ) MonarchRecordBytes();
+            new ( tSlot.fSeparateOneBytes ) MonarchRecordBytes();
+            if( tSlot.fSeparateTwoBytes != NULL ) new ( tSlot.fSeparateTwoBytes ) MonarchRecordBytes();
+
+            fFree.Push( &tSlot );
+        }
+    }
+    MonarchRecordPool::~MonarchRecordPool()
+    {
+        delete[] fSlots;
+        delete[] fArena;
+    }
+
+    MonarchRecordSlot* MonarchRecordPool::Acquire( bool aWait )
+    {
+        MonarchRecordSlot* tSlot = fFree.TryPop();
+        if( tSlot == NULL )
+        {
+            if( fHeld == fNSlots )
+            {
+                throw MonarchException() << "all <" << fNSlots << "> record slots are in use and none has been committed";
+            }
+            if( aWait == false )
+            {
+                return NULL;
+            }
+
+            uint64_t tStart = Now();
+            tSlot = fFree.Pop();
+            ++fStalls;
+            fStallTime += Now() - tStart;
+        }
+
+        tSlot->fNSegments = 0;
+        ++fHeld;
+        return tSlot;
+    }
+
+}
@@ -0,0 +1,113 @@
+#ifndef MONARCHRECORDPOOL_HPP_
+#define MONARCHRECORDPOOL_HPP_
+
+#include "MonarchRecord.hpp"
+#include "MonarchSlotQueue.hpp"
+
+namespace monarch
+{
+
+    //one set of record buffers from the pool (interleaved, channel one and, for two channels, channel two),
+    //plus the byte ranges of those buffers that have to go to the file once the slot is committed.
+    struct MonarchRecordSlot
+    {
+            byte_type* fInterleavedBytes;
+            byte_type* fSeparateOneBytes;
+            byte_type* fSeparateTwoBytes;
+
+            unsigned fNSegments;
+            const byte_type* fSegments[ 2 ];
+            size_t fSegmentNBytes[ 2 ];
+
+            MonarchRecordBytes* GetRecordInterleaved();
+            MonarchRecordBytes* GetRecordSeparateOne();
+            MonarchRecordBytes* GetRecordSeparateTwo();
+
+            void Append( const byte_type* aBytes, size_t aNBytes );
+    };
+
+    inline MonarchRecordBytes* MonarchRecordSlot::GetRecordInterleaved()
+    {
+        return reinterpret_cast< MonarchRecordBytes* >( fInterleavedBytes );
+    }
+    inline MonarchRecordBytes* MonarchRecordSlot::GetRecordSeparateOne()
+    {
+        return reinterpret_cast< MonarchRecordBytes* >( fSeparateOneBytes );
+    }
+    inline MonarchRecordBytes* MonarchRecordSlot::GetRecordSeparateTwo()
+    {
+        return reinterpret_cast< MonarchRecordBytes* >( fSeparateTwoBytes );
+    }
+    inline void MonarchRecordSlot::Append( const byte_type* aBytes, size_t aNBytes )
+    {
+        fSegments[ fNSegments ] = aBytes;
+        fSegmentNBytes[ fNSegments ] = aNBytes;
+        ++fNSegments;
+    }
+
+    //fixed set of record slots carved out of a single arena.
+    //slots are acquired by the producer, filled in place (e.g. as DMA targets), committed,
+    //and come back through Release once they have been written.
+    //Acquire and Release may be called from different threads (one each).
+    class MonarchRecordPool
+    {
+        public:
+            //the buffers start on anAlignment-byte boundaries, or on cache lines if that is smaller, and are zeroed.
+            MonarchRecordPool( unsigned aNSlots, size_t anInterleavedNBytes, size_t aSeparateNBytes, bool aTwoChannels, size_t anAlignment = 0 );
+            ~MonarchRecordPool();
+
+            //take a free slot; blocks until one is released if aWait is true, otherwise returns NULL when none is free.
+            //throws if every slot is already held by the caller, since none could ever come back.
+            MonarchRecordSlot* Acquire( bool aWait );
+
+            //the slot is about to be written (producer side)
+            void Committed( MonarchRecordSlot* aSlot );
+
+            //return a written slot to the pool
+            void Release( MonarchRecordSlot* aSlot );
+
+            unsigned GetNSlots() const;
+
+            //number of times Acquire had to wait, and for how long in total (ns)
+            uint64_t GetStalls() const;
+            uint64_t GetStallTime() const;
+
+        private:
+            unsigned fNSlots;
+            MonarchRecordSlot* fSlots;
+            byte_type* fArena;
+            MonarchSlotQueue fFree;
+
+            //slots acquired but not yet committed (producer only)
+            unsigned fHeld;
+
+            uint64_t fStalls;
+            uint64_t fStallTime;
+    };
+
+    inline void MonarchRecordPool::Committed( MonarchRecordSlot* )
+    {
+        --fHeld;
+        return;
+    }
+    inline void MonarchRecordPool::Release( MonarchRecordSlot* aSlot )
+    {
+        fFree.Push( aSlot );
+        return;
+    }
+    inline unsigned MonarchRecordPool::GetNSlots() const
+    {
+        return fNSlots;
+    }
+    inline uint64_t MonarchRecordPool::GetStalls() const
+    {
+        return fStalls;
+    }
+    inline uint64_t MonarchRecordPool::GetStallTime() const
+    {
+        return fStallTime;
+    }
+
+}
+
+#endif
@@ -0,0 +1,356 @@
+#include "MonarchRollingWriter.hpp"
+
+#include "MonarchException.hpp"
+
+#include <cstdio>
+#include <sstream>
+using std::stringstream;
+
+namespace monarch
+{
+
+    MonarchRollingWriter::MonarchRollingWriter( const string& aFilename, IOModeType anIOMode ) :
+            fFilename( aFilename ),
+            fIOMode( anIOMode ),
+            fHeader(),
+            fMaxNBytes( 0 ),
+            fMaxNRecords( 0 ),
+            fMaxTime( 0 ),
+            fNSlots( 0 ),
+            fPreallocate( false ),
+            fInterfaceSet( false ),
+            fInterface( sInterfaceSeparate ),
+            fCurrent( NULL ),
+            fIndex( 0 ),
+            fNext( NULL ),
+            fRetired(),
+            fError(),
+            fRunning( false ),
+            fStopping( false )
+    {
+        pthread_mutex_init( &fMutex, NULL );
+        pthread_cond_init( &fWork, NULL );
+        pthread_cond_init( &fReady, NULL );
+    }
+    MonarchRollingWriter::~MonarchRollingWriter()
+    {
+        if( fRunning == true )
+        {
+            try
+            {
+                Close();
+            }
+            catch( MonarchException& )
+            {
+            }
+        }
+        delete fCurrent;
+
+        pthread_cond_destroy( &fReady );
+        pthread_cond_destroy( &fWork );
+        pthread_mutex_destroy( &fMutex );
+    }
+
+    MonarchHeader* MonarchRollingWriter::GetHeader()
+    {
+        return &fHeader;
+    }
+
+    void MonarchRollingWriter::SetRollover( uint64_t aMaxNBytes, uint64_t aMaxNRecords, TimeType aMaxTime )
+    {
+        if( fCurrent != NULL )
+        {
+            throw MonarchException() << "the rollover limits have to be set before the header is written";
+        }
+        fMaxNBytes = aMaxNBytes;
+        fMaxNRecords = aMaxNRecords;
+        fMaxTime = aMaxTime;
+        return;
+    }
+
+    void MonarchRollingWriter::SetAsyncWriting( unsigned aNSlots )
+    {
+        if( fCurrent != NULL )
+        {
+            throw MonarchException() << "asynchronous writing has to be set before the header is written";
+        }
+        fNSlots = aNSlots;
+        return;
+    }
+
+    void MonarchRollingWriter::SetPreallocation( bool aFlag )
+    {
+        if( fCurrent != NULL )
+        {
+            throw MonarchException() << "preallocation has to be set before the header is written";
+        }
+        fPreallocate = aFlag;
+        return;
+    }
+
+    void MonarchRollingWriter::SetInterface( InterfaceModeType aMode )
+    {
+        // the next file may be in preparation, so it picks the interface up when it is swapped in
+        fInterfaceSet = true;
+        fInterface = aMode;
+        if( fCurrent != NULL )
+        {
+            fCurrent->SetInterface( aMode );
+        }
+        return;
+    }
+
+    string MonarchRollingWriter::GetFilename( unsigned anIndex ) const
+    {
+        string::size_type tDot = fFilename.rfind( '.' );
+        string::size_type tSlash = fFilename.rfind( '/' );
+        if( tDot == string::npos || (tSlash != string::npos && tDot < tSlash) )
+        {
+            tDot = fFilename.size();
+        }
+        stringstream tName;
+        tName << fFilename.substr( 0, tDot ) << "_" << anIndex << fFilename.substr( tDot );
+        return tName.str();
+    }
+
+    unsigned MonarchRollingWriter::GetFileIndex() const
+    {
+        return fIndex;
+    }
+
+    Monarch* MonarchRollingWriter::Prepare( unsigned anIndex )
+    {
+        string tFilename = GetFilename( anIndex );
+        Monarch* tMonarch = Monarch::OpenForWriting( tFilename, fIOMode );
+        try
+        {
+            tMonarch->GetHeader()->CopyFrom( fHeader );
+            tMonarch->GetHeader()->SetFilename( tFilename );
+            if( fNSlots > 0 )
+            {
+                tMonarch->SetAsyncWriting( fNSlots );
+            }
+            if( fPreallocate == true )
+            {
+                tMonarch->SetPreallocation( true, fMaxNBytes );
+            }
+            tMonarch->WriteHeader();
+        }
+        catch( MonarchException& )
+        {
+            delete tMonarch;
+            throw;
+        }
+        return tMonarch;
+    }
+
+    void MonarchRollingWriter::WriteHeader()
+    {
+        if( fCurrent != NULL )
+        {
+            throw MonarchException() << "the header has already been written";
+        }
+        fCurrent = Prepare( 0 );
+        if( fInterfaceSet == true )
+        {
+            fCurrent->SetInterface( fInterface );
+        }
+        fIndex = 0;
+
+        fStopping = false;
+        if( pthread_create( &fThread, NULL, &MonarchRollingWriter::Run, this ) != 0 )
+        {
+            throw MonarchException() << "could not start the thread that prepares the next file";
+        }
+        fRunning = true;
+        return;
+    }
+
+    bool MonarchRollingWriter::IsFull() const
+    {
+        const MonarchFooter* tFooter = fCurrent->GetFooter();
+        if( fMaxNBytes != 0 && tFooter->GetRecordsNBytes() >= fMaxNBytes )
+        {
+            return true;
+        }
+        if( fMaxNRecords != 0 && tFooter->GetNRecords() >= fMaxNRecords )
+        {
+            return true;
+        }
+        if( fMaxTime != 0 && tFooter->GetNRecords() > 0 && tFooter->GetLastTime() - tFooter->GetFirstTime() >= fMaxTime )
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool MonarchRollingWriter::WriteRecord()
+    {
+        if( fCurrent->WriteRecord() == false )
+        {
+            return false;
+        }
+        if( IsFull() == true )
+        {
+            Roll();
+        }
+        return true;
+    }
+
+    void MonarchRollingWriter::Roll()
+    {
+        pthread_mutex_lock( &fMutex );
+        while( fNext == NULL && fError.empty() == true )
+        {
+            pthread_cond_wait( &fReady, &fMutex );
+        }
+        if( fError.empty() == false )
+        {
+            string tError = fError;
+            pthread_mutex_unlock( &fMutex );
+            throw MonarchException() << tError;
+        }
+        fRetired.push_back( fCurrent );
+        fCurrent = fNext;
+        fNext = NULL;
+        ++fIndex;
+        pthread_cond_signal( &fWork );
+        pthread_mutex_unlock( &fMutex );
+
+        if( fInterfaceSet == true )
+        {
+            fCurrent->SetInterface( fInterface );
+        }
+        return;
+    }
+
+    MonarchRecordBytes* MonarchRollingWriter::GetRecordInterleaved()
+    {
+        return fCurrent->GetRecordInterleaved();
+    }
+    MonarchRecordBytes* MonarchRollingWriter::GetRecordSeparateOne()
+    {
+        return fCurrent->GetRecordSeparateOne();
+    }
+    MonarchRecordBytes* MonarchRollingWriter::GetRecordSeparateTwo()
+    {
+        return fCurrent->GetRecordSeparateTwo();
+    }
+
+    void* MonarchRollingWriter::Run( void* anArgument )
+    {
+        static_cast< MonarchRollingWriter* >( anArgument )->Execute();
+        return NULL;
+    }
+
+    void MonarchRollingWriter::Execute()
+    {
+        pthread_mutex_lock( &fMutex );
+        while( true )
+        {
+            // keep the next file ready first, since the writer may be waiting for it; then close the finished ones
+            if( fNext == NULL && fStopping == false && fError.empty() == true )
+            {
+                unsigned tIndex = fIndex + 1;
+                pthread_mutex_unlock( &fMutex );
+                Monarch* tNext = NULL;
+                string tError;
+                try
+                {
+                    tNext = Prepare( tIndex );
+                }
+                catch( MonarchException& )
+                {
+                    tError = "could not prepare <" + GetFilename( tIndex ) + ">";
+                }
+                pthread_mutex_lock( &fMutex );
+                fNext = tNext;
+                if( tError.empty() == false && fError.empty() == true )
+                {
+                    fError = tError;
+                }
+                pthread_cond_broadcast( &fReady );
+                continue;
+            }
+            if( fRetired.empty() == false )
+            {
+                Monarch* tRetired = fRetired.front();
+                fRetired.erase( fRetired.begin() );
+                pthread_mutex_unlock( &fMutex );
+                string tError;
+                try
+                {
+                    tRetired->Close();
+                }
+                catch( MonarchException& )
+                {
+                    tError = "could not close <" + tRetired->GetHeader()->GetFilename() + ">";
+                }
+                delete tRetired;
+                pthread_mutex_lock( &fMutex );
+                if( tError.empty() == false && fError.empty() == true )
+                {
+                    fError = tError;
+                }
+                continue;
+            }
+            if( fStopping == true )
+            {
+                break;
+            }
+            pthread_cond_wait( &fWork, &fMutex );
+        }
+        pthread_mutex_unlock( &fMutex );
+        return;
+    }
+
+    void MonarchRollingWriter::Close()
+    {
+        if( fRunning == true )
+        {
+            pthread_mutex_lock( &fMutex );
+            fStopping = true;
+            pthread_cond_signal( &fWork );
+            pthread_mutex_unlock( &fMutex );
+            pthread_join( fThread, NULL );
+            fRunning = false;
+        }
+
+        // the file prepared for records that never came is not part of the run
+        if( fNext != NULL )
+        {
+            string tFilename = fNext->GetHeader()->GetFilename();
+            try
+            {
+                fNext->Close();
+            }
+            catch( MonarchException& )
+            {
+            }
+            delete fNext;
+            fNext = NULL;
+            remove( tFilename.c_str() );
+        }
+
+        if( fCurrent != NULL )
+        {
+            // a run that ends right at a limit leaves a file without records behind the last one
+            bool tEmpty = fIndex > 0 && fCurrent->GetFooter()->GetNRecords() == 0;
+            string tFilename = fCurrent->GetHeader()->GetFilename();
+            fCurrent->Close();
+            delete fCurrent;
+            fCurrent = NULL;
+            if( tEmpty == true )
+            {
+                remove( tFilename.c_str() );
+            }
+        }
+
+        if( fError.empty() == false )
+        {
+            throw MonarchException() << fError;
+        }
+        return;
+    }
+
+}
@@ -0,0 +1,113 @@
+#ifndef MONARCHROLLINGWRITER_HPP_
+#define MONARCHROLLINGWRITER_HPP_
+
+#include "Monarch.hpp"
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+using std::string;
+
+namespace monarch
+{
+
+    //writes a run as a sequence of egg files, moving on to the next file when the current one reaches a size,
+    //record-count or time limit. the files are named after aFilename with the index of the file before the extension
+    //(run.egg gives run_0.egg, run_1.egg, ...), and each one is a complete egg file with its own header and footer.
+    //the next file is opened and its header written on a background thread while the current one is being filled,
+    //and finished files are closed there too, so moving on inside WriteRecord only swaps pointers.
+    //the records belong to the current file, so as with a record pool the record getters have to be called again after every WriteRecord.
+    class MonarchRollingWriter
+    {
+        public:
+            MonarchRollingWriter( const string& aFilename, IOModeType anIOMode = sIOAuto );
+            ~MonarchRollingWriter();
+
+            //get the pointer to the header every file is written with; the filename is set for each file.
+            MonarchHeader* GetHeader();
+
+            //limits of a file: bytes of records before compression, records, and ns from the first record to the last.
+            //a limit of 0 is no limit. it must be called before WriteHeader.
+            void SetRollover( uint64_t aMaxNBytes, uint64_t aMaxNRecords, TimeType aMaxTime );
+
+            //set up every file for asynchronous writing (see Monarch::SetAsyncWriting).
+            //it must be called before WriteHeader.
+            void SetAsyncWriting( unsigned aNSlots );
+
+            //reserve space for every file, up to the size limit (see Monarch::SetPreallocation).
+            //it must be called before WriteHeader.
+            void SetPreallocation( bool aFlag );
+
+            //set the interface type to use for every file.
+            void SetInterface( InterfaceModeType aMode );
+
+            //open the first file and write its header, and start preparing the next one.
+            void WriteHeader();
+
+            //write the current record, and move on to the next file if the current one has reached a limit.
+            //an exception is thrown if the next file could not be prepared, or an earlier file could not be closed.
+            bool WriteRecord();
+
+            //get the pointers to the current records of the current file
+            MonarchRecordBytes* GetRecordInterleaved();
+            MonarchRecordBytes* GetRecordSeparateOne();
+            MonarchRecordBytes* GetRecordSeparateTwo();
+
+            //index of the current file
+            unsigned GetFileIndex() const;
+
+            //name of the file with index anIndex
+            string GetFilename( unsigned anIndex ) const;
+
+            //close the current file and wait for the earlier ones; files that were opened but got no records are removed.
+            void Close();
+
+        private:
+            string fFilename;
+            IOModeType fIOMode;
+            MonarchHeader fHeader;
+
+            uint64_t fMaxNBytes;
+            uint64_t fMaxNRecords;
+            TimeType fMaxTime;
+
+            unsigned fNSlots;
+            bool fPreallocate;
+            bool fInterfaceSet;
+            InterfaceModeType fInterface;
+
+            //the file being written and its index
+            Monarch* fCurrent;
+            unsigned fIndex;
+
+            //the file prepared next, once the background thread has it ready
+            Monarch* fNext;
+            //finished files waiting to be closed
+            std::vector< Monarch* > fRetired;
+            //the first error of the background thread
+            string fError;
+
+            pthread_t fThread;
+            bool fRunning;
+            bool fStopping;
+            pthread_mutex_t fMutex;
+            pthread_cond_t fWork;
+            pthread_cond_t fReady;
+
+            static void* Run( void* anArgument );
+            void Execute();
+
+            //open the file with index anIndex and write its header
+            Monarch* Prepare( unsigned anIndex );
+
+            //true if the current file has reached a limit
+            bool IsFull() const;
+
+            //move on to the prepared file
+            void Roll();
+    };
+
+}
+
+#endif
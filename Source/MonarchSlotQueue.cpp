@@ -0,0 +1,93 @@
+#include "MonarchSlotQueue.hpp"
+
+namespace monarch
+{
+
+    MonarchSlotQueue::MonarchSlotQueue( unsigned aCapacity ) :
+            fRing( new MonarchRecordSlot*[ aCapacity ] ),
+            fCapacity( aCapacity ),
+            fHead( 0 ),
+            fTail( 0 ),
+            fWaiting( 0 ),
+            fClosed( 0 )
+    {
+        pthread_mutex_init( &fMutex, NULL );
+        pthread_cond_init( &fNotEmpty, NULL );
+    }
+    MonarchSlotQueue::~MonarchSlotQueue()
+    {
+        pthread_cond_destroy( &fNotEmpty );
+        pthread_mutex_destroy( &fMutex );
+        delete[] fRing;
+    }
+
+    void MonarchSlotQueue::Push( MonarchRecordSlot* aSlot )
+    {
+        uint64_t tTail = fTail;
+        fRing[ tTail % fCapacity ] = aSlot;
+        //sequentially consistent, so that either the consumer sees the new slot or we see it waiting
+        __atomic_store_n( &fTail, tTail + 1, __ATOMIC_SEQ_CST );
+        if( __atomic_load_n( &fWaiting, __ATOMIC_SEQ_CST ) != 0 )
+        {
+            pthread_mutex_lock( &fMutex );
+            pthread_cond_signal( &fNotEmpty );
+            pthread_mutex_unlock( &fMutex );
+        }
+        return;
+    }
+
+    MonarchRecordSlot* MonarchSlotQueue::TryPop()
+    {
+        uint64_t tHead = fHead;
+        if( tHead == __atomic_load_n( &fTail, __ATOMIC_ACQUIRE ) )
+        {
+            return NULL;
+        }
+        MonarchRecordSlot* tSlot = fRing[ tHead % fCapacity ];
+        __atomic_store_n( &fHead, tHead + 1, __ATOMIC_RELEASE );
+        return tSlot;
+    }
+
+    MonarchRecordSlot* MonarchSlotQueue::Pop()
+    {
+        while( true )
+        {
+            MonarchRecordSlot* tSlot = TryPop();
+            if( tSlot != NULL )
+            {
+                return tSlot;
+            }
+
+            pthread_mutex_lock( &fMutex );
+            __atomic_store_n( &fWaiting, 1, __ATOMIC_SEQ_CST );
+            bool tEmpty = fHead == __atomic_load_n( &fTail, __ATOMIC_SEQ_CST );
+            bool tClosed = __atomic_load_n( &fClosed, __ATOMIC_SEQ_CST ) != 0;
+            if( tEmpty == true && tClosed == false )
+            {
+                pthread_cond_wait( &fNotEmpty, &fMutex );
+            }
+            __atomic_store_n( &fWaiting, 0, __ATOMIC_SEQ_CST );
+            pthread_mutex_unlock( &fMutex );
+
+            if( tEmpty == true && tClosed == true )
+            {
+                return NULL;
+            }
+        }
+    }
+
+    void MonarchSlotQueue::Close()
+    {
+        __atomic_store_n( &fClosed, 1, __ATOMIC_SEQ_CST );
+        pthread_mutex_lock( &fMutex );
+        pthread_cond_broadcast( &fNotEmpty );
+        pthread_mutex_unlock( &fMutex );
+        return;
+    }
+
+    unsigned MonarchSlotQueue::Size() const
+    {
+        return __atomic_load_n( &fTail, __ATOMIC_ACQUIRE ) - __atomic_load_n( &fHead, __ATOMIC_ACQUIRE );
+    }
+
+}
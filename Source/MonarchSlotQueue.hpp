@@ -0,0 +1,54 @@
+#ifndef MONARCHSLOTQUEUE_HPP_
+#define MONARCHSLOTQUEUE_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <pthread.h>
+
+namespace monarch
+{
+
+    struct MonarchRecordSlot;
+
+    //single-producer/single-consumer queue of record slots.
+    //the ring itself is lock-free; the mutex is only taken when the consumer has to sleep
+    //or when the producer has to wake it.
+    //the capacity has to cover every slot that can be in the queue, so Push never blocks.
+    class MonarchSlotQueue
+    {
+        public:
+            MonarchSlotQueue( unsigned aCapacity );
+            ~MonarchSlotQueue();
+
+            //append a slot (producer side)
+            void Push( MonarchRecordSlot* aSlot );
+
+            //take the oldest slot (consumer side); blocks while the queue is empty
+            //and returns NULL once the queue is closed and empty.
+            MonarchRecordSlot* Pop();
+
+            //take the oldest slot, or NULL if the queue is empty
+            MonarchRecordSlot* TryPop();
+
+            //wake the consumer and make Pop return NULL once the queue has drained
+            void Close();
+
+            //number of slots in the queue
+            unsigned Size() const;
+
+        private:
+            MonarchRecordSlot** fRing;
+            unsigned fCapacity;
+
+            volatile uint64_t fHead;
+            volatile uint64_t fTail;
+            volatile uint32_t fWaiting;
+            volatile uint32_t fClosed;
+
+            pthread_mutex_t fMutex;
+            pthread_cond_t fNotEmpty;
+    };
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "MonarchStripedReader.hpp"
+
+#include "MonarchException.hpp"
+
+namespace monarch
+{
+
+    MonarchStripedReader::MonarchStripedReader( const string& aFilename, IOModeType anIOMode ) :
+            fFilename( aFilename ),
+            fIOMode( anIOMode ),
+            fManifest(),
+            fStripes(),
+            fStripe( 0 ),
+            fNRead( 0 ),
+            fNRecords( 0 )
+    {
+    }
+    MonarchStripedReader::~MonarchStripedReader()
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            delete fStripes[ tStripe ];
+        }
+    }
+
+    void MonarchStripedReader::ReadHeader()
+    {
+        if( fManifest.DemarshalFromFile( fFilename ) == false )
+        {
+            throw MonarchException() << "<" << fFilename << "> is not the manifest of a striped run";
+        }
+        if( fManifest.GetNStripes() == 0 || fManifest.GetStripeNRecords() == 0 )
+        {
+            throw MonarchException() << "the manifest <" << fFilename << "> lists no records";
+        }
+
+        for( unsigned tStripe = 0; tStripe < fManifest.GetNStripes(); ++tStripe )
+        {
+            const Monarch* tMonarch = Monarch::OpenForReading( fManifest.GetStripe( tStripe ), fIOMode );
+            fStripes.push_back( tMonarch );
+            tMonarch->ReadHeader();
+
+            const MonarchHeader* tFirst = fStripes[ 0 ]->GetHeader();
+            const MonarchHeader* tHeader = tMonarch->GetHeader();
+            if( tHeader->GetAcquisitionMode() != tFirst->GetAcquisitionMode() || tHeader->GetFormatMode() != tFirst->GetFormatMode() || tHeader->GetRecordSize() != tFirst->GetRecordSize() || tHeader->GetDataTypeSize() != tFirst->GetDataTypeSize() )
+            {
+                throw MonarchException() << "the records of <" << fManifest.GetStripe( tStripe ) << "> do not match those of <" << fManifest.GetStripe( 0 ) << ">";
+            }
+        }
+
+        fStripe = 0;
+        fNRead = 0;
+        fNRecords = 0;
+        return;
+    }
+
+    const MonarchHeader* MonarchStripedReader::GetHeader() const
+    {
+        return fStripes[ 0 ]->GetHeader();
+    }
+
+    const MonarchManifest* MonarchStripedReader::GetManifest() const
+    {
+        return &fManifest;
+    }
+
+    uint64_t MonarchStripedReader::GetNRecords() const
+    {
+        if( fManifest.GetNRecords() != 0 )
+        {
+            return fManifest.GetNRecords();
+        }
+
+        // the records of a run that was not closed are read up to the first turn a file cannot fill
+        uint64_t tTurn = fManifest.GetStripeNRecords();
+        uint64_t tNRecords = 0;
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            uint64_t tStripeNRecords = fStripes[ tStripe ]->GetNRecords();
+            uint64_t tNTurns = tStripeNRecords / tTurn;
+            uint64_t tRunNRecords = tNTurns * tTurn * fStripes.size() + tStripe * tTurn + tStripeNRecords % tTurn;
+            if( tStripe == 0 || tRunNRecords < tNRecords )
+            {
+                tNRecords = tRunNRecords;
+            }
+        }
+        return tNRecords;
+    }
+
+    void MonarchStripedReader::SetInterface( InterfaceModeType aMode )
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            fStripes[ tStripe ]->SetInterface( aMode );
+        }
+        return;
+    }
+
+    void MonarchStripedReader::SetChannelMask( ChannelMaskType aMask )
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            fStripes[ tStripe ]->SetChannelMask( aMask );
+        }
+        return;
+    }
+
+    bool MonarchStripedReader::ReadRecord()
+    {
+        if( fNRead == fManifest.GetStripeNRecords() )
+        {
+            fNRead = 0;
+            fStripe = (fStripe + 1) % fStripes.size();
+        }
+        if( fStripes[ fStripe ]->ReadRecord() == false )
+        {
+            return false;
+        }
+        ++fNRead;
+        ++fNRecords;
+        return true;
+    }
+
+    uint64_t MonarchStripedReader::GetRecordIndex() const
+    {
+        return fNRecords - 1;
+    }
+
+    const MonarchRecordBytes* MonarchStripedReader::GetRecordInterleaved() const
+    {
+        return fStripes[ fStripe ]->GetRecordInterleaved();
+    }
+    const MonarchRecordBytes* MonarchStripedReader::GetRecordSeparateOne() const
+    {
+        return fStripes[ fStripe ]->GetRecordSeparateOne();
+    }
+    const MonarchRecordBytes* MonarchStripedReader::GetRecordSeparateTwo() const
+    {
+        return fStripes[ fStripe ]->GetRecordSeparateTwo();
+    }
+
+    void MonarchStripedReader::Close()
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            fStripes[ tStripe ]->Close();
+            delete fStripes[ tStripe ];
+        }
+        fStripes.clear();
+        return;
+    }
+
+}
@@ -0,0 +1,69 @@
+#ifndef MONARCHSTRIPEDREADER_HPP_
+#define MONARCHSTRIPEDREADER_HPP_
+
+#include "Monarch.hpp"
+#include "MonarchManifest.hpp"
+
+#include <string>
+#include <vector>
+using std::string;
+
+namespace monarch
+{
+
+    //reads a run written by MonarchStripedWriter back as one stream of records, in the order they were written.
+    //the records are taken from the files in the turns the manifest gives, and keep the record ids they were written with.
+    //each file is read through its own backend, so with sIOReadAhead the devices are read at the same time.
+    //the stream ends with the first turn that a file cannot fill, as it does where a run was not closed.
+    class MonarchStripedReader
+    {
+        public:
+            MonarchStripedReader( const string& aFilename, IOModeType anIOMode = sIOAuto );
+            ~MonarchStripedReader();
+
+            //read the manifest aFilename, open the files it lists and read their headers.
+            //an exception is thrown if the manifest or one of the files cannot be read, or the headers do not agree.
+            void ReadHeader();
+
+            //get the pointer to the header of the first file.
+            const MonarchHeader* GetHeader() const;
+
+            //get the pointer to the manifest.
+            const MonarchManifest* GetManifest() const;
+
+            //get the number of records in the run: from the manifest of a closed run, and otherwise from the files.
+            uint64_t GetNRecords() const;
+
+            //set the interface type and the channel mask of every file (see Monarch).
+            void SetInterface( InterfaceModeType aMode );
+            void SetChannelMask( ChannelMaskType aMask );
+
+            //read the next record of the run; false at the end.
+            bool ReadRecord();
+
+            //index of the current record in the run, counting from 0
+            uint64_t GetRecordIndex() const;
+
+            //get the pointers to the current records; call them again after every ReadRecord.
+            const MonarchRecordBytes* GetRecordInterleaved() const;
+            const MonarchRecordBytes* GetRecordSeparateOne() const;
+            const MonarchRecordBytes* GetRecordSeparateTwo() const;
+
+            //close the files.
+            void Close();
+
+        private:
+            string fFilename;
+            IOModeType fIOMode;
+            MonarchManifest fManifest;
+
+            //the files, the one the current record comes from, and the records read from it in this turn
+            std::vector< const Monarch* > fStripes;
+            unsigned fStripe;
+            unsigned fNRead;
+            uint64_t fNRecords;
+    };
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "MonarchStripedWriter.hpp"
+
+#include "MonarchException.hpp"
+
+#include <cstdlib>
+
+#include <sstream>
+using std::stringstream;
+
+namespace monarch
+{
+
+    MonarchStripedWriter::MonarchStripedWriter( const string& aFilename, const std::vector< string >& aDirectories, IOModeType anIOMode ) :
+            fFilename( aFilename ),
+            fDirectories( aDirectories ),
+            fIOMode( anIOMode ),
+            fHeader(),
+            fManifest(),
+            fStripeNRecords( 0 ),
+            fNSlots( 4 ),
+            fStripes(),
+            fStripe( 0 ),
+            fNWritten( 0 )
+    {
+        if( fDirectories.empty() == true )
+        {
+            throw MonarchException() << "a striped run needs at least one directory";
+        }
+    }
+    MonarchStripedWriter::~MonarchStripedWriter()
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            try
+            {
+                fStripes[ tStripe ]->Close();
+            }
+            catch( MonarchException& )
+            {
+            }
+            delete fStripes[ tStripe ];
+        }
+    }
+
+    MonarchHeader* MonarchStripedWriter::GetHeader()
+    {
+        return &fHeader;
+    }
+
+    void MonarchStripedWriter::SetStripeNRecords( unsigned aNRecords )
+    {
+        if( fStripes.empty() == false )
+        {
+            throw MonarchException() << "the records per stripe have to be set before the header is written";
+        }
+        fStripeNRecords = aNRecords;
+        return;
+    }
+
+    void MonarchStripedWriter::SetAsyncWriting( unsigned aNSlots )
+    {
+        if( fStripes.empty() == false )
+        {
+            throw MonarchException() << "asynchronous writing has to be set before the header is written";
+        }
+        if( aNSlots == 0 )
+        {
+            throw MonarchException() << "the stripes are written asynchronously, so they need at least one record slot";
+        }
+        fNSlots = aNSlots;
+        return;
+    }
+
+    void MonarchStripedWriter::SetInterface( InterfaceModeType aMode )
+    {
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            fStripes[ tStripe ]->SetInterface( aMode );
+        }
+        return;
+    }
+
+    unsigned MonarchStripedWriter::GetNStripes() const
+    {
+        return fDirectories.size();
+    }
+
+    string MonarchStripedWriter::GetStripeFilename( unsigned anIndex ) const
+    {
+        string tName = fFilename;
+        string::size_type tSlash = tName.rfind( '/' );
+        if( tSlash != string::npos )
+        {
+            tName = tName.substr( tSlash + 1 );
+        }
+        string::size_type tDot = tName.rfind( '.' );
+        if( tDot == string::npos )
+        {
+            tDot = tName.size();
+        }
+        stringstream tStripeName;
+        tStripeName << fDirectories[ anIndex ] << "/" << tName.substr( 0, tDot ) << "_" << anIndex << tName.substr( tDot );
+        return tStripeName.str();
+    }
+
+    void MonarchStripedWriter::WriteHeader()
+    {
+        if( fStripes.empty() == false )
+        {
+            throw MonarchException() << "the header has already been written";
+        }
+
+        for( unsigned tStripe = 0; tStripe < fDirectories.size(); ++tStripe )
+        {
+            string tFilename = GetStripeFilename( tStripe );
+            Monarch* tMonarch = Monarch::OpenForWriting( tFilename, fIOMode );
+            fStripes.push_back( tMonarch );
+            tMonarch->GetHeader()->CopyFrom( fHeader );
+            tMonarch->GetHeader()->SetFilename( tFilename );
+            tMonarch->SetAsyncWriting( fNSlots );
+            tMonarch->WriteHeader();
+
+            // the directories may be given relative to the working directory of the writer, which a reader need not share
+            char* tPath = realpath( tFilename.c_str(), NULL );
+            if( tPath == NULL )
+            {
+                throw MonarchException() << "could not resolve the path of <" << tFilename << ">";
+            }
+            fManifest.AddStripe( tPath );
+            free( tPath );
+        }
+
+        if( fStripeNRecords == 0 )
+        {
+            uint64_t tRecordNBytes = fStripes[ 0 ]->GetFooter()->GetRecordNBytes();
+            fStripeNRecords = (1024 * 1024 + tRecordNBytes - 1) / tRecordNBytes;
+        }
+        fManifest.SetStripeNRecords( fStripeNRecords );
+
+        // the manifest is there from the start, so the stripes of a run that was not closed can still be read
+        if( fManifest.MarshalToFile( fFilename ) == false )
+        {
+            throw MonarchException() << "could not write the manifest <" << fFilename << ">";
+        }
+
+        fStripe = 0;
+        fNWritten = 0;
+        return;
+    }
+
+    bool MonarchStripedWriter::WriteRecord()
+    {
+        if( fStripes[ fStripe ]->WriteRecord() == false )
+        {
+            return false;
+        }
+        if( ++fNWritten == fStripeNRecords )
+        {
+            fNWritten = 0;
+            fStripe = (fStripe + 1) % fStripes.size();
+        }
+        return true;
+    }
+
+    MonarchRecordBytes* MonarchStripedWriter::GetRecordInterleaved()
+    {
+        return fStripes[ fStripe ]->GetRecordInterleaved();
+    }
+    MonarchRecordBytes* MonarchStripedWriter::GetRecordSeparateOne()
+    {
+        return fStripes[ fStripe ]->GetRecordSeparateOne();
+    }
+    MonarchRecordBytes* MonarchStripedWriter::GetRecordSeparateTwo()
+    {
+        return fStripes[ fStripe ]->GetRecordSeparateTwo();
+    }
+
+    void MonarchStripedWriter::Close()
+    {
+        // every file is closed even if one of them fails, and the manifest is written anyway
+        uint64_t tNRecords = 0;
+        string tFailed;
+        for( unsigned tStripe = 0; tStripe < fStripes.size(); ++tStripe )
+        {
+            tNRecords += fStripes[ tStripe ]->GetFooter()->GetNRecords();
+            try
+            {
+                fStripes[ tStripe ]->Close();
+            }
+            catch( MonarchException& )
+            {
+                if( tFailed.empty() == true )
+                {
+                    tFailed = GetStripeFilename( tStripe );
+                }
+            }
+            delete fStripes[ tStripe ];
+        }
+        fStripes.clear();
+
+        fManifest.SetNRecords( tNRecords );
+        if( fManifest.MarshalToFile( fFilename ) == false )
+        {
+            throw MonarchException() << "could not write the manifest <" << fFilename << ">";
+        }
+        if( tFailed.empty() == false )
+        {
+            throw MonarchException() << "could not close <" << tFailed << ">";
+        }
+        return;
+    }
+
+}
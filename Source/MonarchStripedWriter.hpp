@@ -0,0 +1,78 @@
+#ifndef MONARCHSTRIPEDWRITER_HPP_
+#define MONARCHSTRIPEDWRITER_HPP_
+
+#include "Monarch.hpp"
+#include "MonarchManifest.hpp"
+
+#include <string>
+#include <vector>
+using std::string;
+
+namespace monarch
+{
+
+    //writes a run striped over several directories, one egg file in each, so that several devices take the records at once.
+    //the records are dealt out to the files in turns of a fixed number of records, and every file is written asynchronously
+    //on its own thread. the file aFilename itself is the manifest (see MonarchManifest), which MonarchStripedReader reads
+    //to give the records back as one stream with the record ids they were written with.
+    //the file in directory i is named after aFilename with the index of the stripe before the extension
+    //(run.egg gives <directory 0>/run_0.egg, <directory 1>/run_1.egg, ...), and each one is a complete egg file.
+    //the manifest names the files by their canonical paths, so it can be read from any working directory.
+    //the records belong to the file whose turn it is, so the record getters have to be called again after every WriteRecord.
+    class MonarchStripedWriter
+    {
+        public:
+            MonarchStripedWriter( const string& aFilename, const std::vector< string >& aDirectories, IOModeType anIOMode = sIOAuto );
+            ~MonarchStripedWriter();
+
+            //get the pointer to the header every file is written with; the filename is set for each file.
+            MonarchHeader* GetHeader();
+
+            //number of records that go to a file before the next one gets its turn; 0, the default,
+            //takes as many records as fit in 1 MB. it must be called before WriteHeader.
+            void SetStripeNRecords( unsigned aNRecords );
+
+            //number of record slots of the asynchronous writer of each file (4 by default).
+            //it must be called before WriteHeader.
+            void SetAsyncWriting( unsigned aNSlots );
+
+            //set the interface type to use for every file.
+            void SetInterface( InterfaceModeType aMode );
+
+            //open the files, write their headers and write the manifest.
+            void WriteHeader();
+
+            //write the current record to the file whose turn it is.
+            bool WriteRecord();
+
+            //get the pointers to the current records
+            MonarchRecordBytes* GetRecordInterleaved();
+            MonarchRecordBytes* GetRecordSeparateOne();
+            MonarchRecordBytes* GetRecordSeparateTwo();
+
+            //number of files, and the name of file anIndex
+            unsigned GetNStripes() const;
+            string GetStripeFilename( unsigned anIndex ) const;
+
+            //close the files and write the number of records to the manifest.
+            void Close();
+
+        private:
+            string fFilename;
+            std::vector< string > fDirectories;
+            IOModeType fIOMode;
+            MonarchHeader fHeader;
+            MonarchManifest fManifest;
+
+            unsigned fStripeNRecords;
+            unsigned fNSlots;
+
+            //the files, the one whose turn it is, and the records it has been given in this turn
+            std::vector< Monarch* > fStripes;
+            unsigned fStripe;
+            unsigned fNWritten;
+    };
+
+}
+
+#endif
@@ -40,25 +40,6 @@ int main( const int argc, const char** argv )
     TimeType tRecordSize = (TimeType)tReadHeader->GetRecordSize();
     TimeType tBinWidthNS = (TimeType)(1000. / tReadHeader->GetAcquisitionRate()); // in ns
 
-    const MonarchRecordBytes* tReadRecord;
-    if( tReadHeader->GetAcquisitionMode() == 1 /* the FormatMode is ignored for single-channel data */ )
-    {
-        tReadRecord = tReadTest->GetRecordSeparateOne();
-    }
-    else if( tReadHeader->GetAcquisitionMode() == 2 && tReadHeader->GetFormatMode() == sFormatMultiSeparate )
-    {
-        tReadRecord = tReadTest->GetRecordSeparateOne();
-    }
-    else if( tReadHeader->GetAcquisitionMode() == 2 && tReadHeader->GetFormatMode() == sFormatMultiInterleaved )
-    {
-        tReadRecord = tReadTest->GetRecordInterleaved();
-    }
-    else
-    {
-        MERROR( mlog, "Unable to read a header with acquisition mode <" << tReadHeader->GetAcquisitionMode() << "> and format mode <" << tReadHeader->GetFormatMode() << ">" );
-        return -1;
-    }
-
     unsigned long long tRecordCount = 0;
     unsigned long long tAcquisitionCount = 0;
 
@@ -66,41 +47,60 @@ int main( const int argc, const char** argv )
     TimeType tNSTimeInRunBins = 0;
     TimeType tNSTimeInRunBinsCorr = 0; // corrected to the Clock time when there's a new acquisition
 
-    // read first record
-    if (! tReadTest->ReadRecord())
+    // only the ids and times are looked at, so the samples are never read;
+    // they are read a window at a time, so a long run does not need more memory than a short one
+    const uint64_t tWindowNRecords = 4096;
+    MonarchRecordMetadata tMetadata;
+    try
     {
-        MERROR( mlog, "No records in the file" );
+        while( tReadTest->ReadMetadata( &tMetadata, tRecordCount, tWindowNRecords ) > 0 )
+        {
+            for( size_t tIndex = 0; tIndex < tMetadata.fTimes.size(); ++tIndex )
+            {
+                tRecordCount = tRecordCount + 1;
+
+                tNSTimeInRunClock = tMetadata.fTimes[ tIndex ];
+
+                if( tRecordCount == 1 )
+                {
+                    // first record
+                    tAcquisitionCount = 1;
+                    tNSTimeInRunBinsCorr = tNSTimeInRunClock;
+                    tNSTimeInRunBins = tNSTimeInRunClock;
+                }
+                else
+                {
+                    if( tMetadata.fAcquisitionIds[ tIndex ] == tAcquisitionCount )
+                    {
+                        cout << "new acquisition" << endl;
+                        tAcquisitionCount = tAcquisitionCount + 1;
+                        tNSTimeInRunBinsCorr = tNSTimeInRunClock;
+                    }
+                    else
+                    {
+                        tNSTimeInRunBinsCorr += tRecordSize * tBinWidthNS;
+                    }
+                    tNSTimeInRunBins += tRecordSize * tBinWidthNS;
+                }
+
+                tOutput << tRecordCount << '\t' << tNSTimeInRunClock << '\t' << tNSTimeInRunBins << '\t' << tNSTimeInRunBinsCorr << '\n';
+            }
+            if( tMetadata.fTimes.size() < tWindowNRecords )
+            {
+                break;
+            }
+        }
+    }
+    catch( MonarchException& e )
+    {
+        MERROR( mlog, "Unable to read the records:\n\t" << e.what() );
         return -1;
     }
-    tRecordCount = 1;
-    tAcquisitionCount = 1;
-    tNSTimeInRunClock = tReadRecord->fTime;
-    tNSTimeInRunBinsCorr = tNSTimeInRunClock;
-    tNSTimeInRunBins = tNSTimeInRunClock;
 
-    tOutput << tRecordCount << '\t' << tNSTimeInRunClock << '\t' << tNSTimeInRunBins << '\t' << tNSTimeInRunBinsCorr << '\n';
-
-    while( tReadTest->ReadRecord() != false )
+    if( tRecordCount == 0 )
     {
-        tRecordCount = tRecordCount + 1;
-
-        tNSTimeInRunClock = tReadRecord->fTime;
-
-        if( tReadRecord->fAcquisitionId == tAcquisitionCount )
-        {
-            cout << "new acquisition" << endl;
-            tAcquisitionCount = tAcquisitionCount + 1;
-            tNSTimeInRunBinsCorr = tNSTimeInRunClock;
-        }
-        else
-        {
-            tNSTimeInRunBinsCorr += tRecordSize * tBinWidthNS;
-        }
-        tNSTimeInRunBins += tRecordSize * tBinWidthNS;
-
-        tOutput << tRecordCount << '\t' << tNSTimeInRunClock << '\t' << tNSTimeInRunBins << '\t' << tNSTimeInRunBinsCorr << '\n';
-
-        //cout << "  record " << tRecordCount << ": time offset: " << tReadRecord->fTime << " ns" << endl;
+        MERROR( mlog, "No records in the file" );
+        return -1;
     }
     MINFO( mlog, "record count <" << tRecordCount << ">" );
     MINFO( mlog, "acquisition count <" << tAcquisitionCount << ">" );
@@ -29,10 +29,23 @@ namespace monarch
     static const AccessModeType sAccessRead = 0;
     static const AccessModeType sAccessWrite = 1;
 
+    typedef uint32_t IOModeType;
+    static const IOModeType sIOBuffered = 0; // stdio
+    static const IOModeType sIOMapped = 1; // mmap, reading only
+    static const IOModeType sIOPositional = 2; // pread/pwrite
+    static const IOModeType sIODirect = 3; // O_DIRECT
+    static const IOModeType sIOAuto = 4; // chosen from the access mode and file size
+    static const IOModeType sIOReadAhead = 5; // io_uring or thread read-ahead, reading only
+
     typedef uint32_t InterfaceModeType;
     static const AccessModeType sInterfaceInterleaved = 0;
     static const AccessModeType sInterfaceSeparate = 1;
 
+    typedef uint32_t ChannelMaskType;
+    static const ChannelMaskType sChannelOne = 0x1;
+    static const ChannelMaskType sChannelTwo = 0x2;
+    static const ChannelMaskType sChannelBoth = 0x3;
+
     typedef uint32_t AcquisitionModeType;
     static const AcquisitionModeType sOneChannel = 1;
     static const AcquisitionModeType sTwoChannel = 2;
@@ -51,6 +64,12 @@ namespace monarch
     static const FormatModeType sFormatMultiSeparate = 1;
     static const FormatModeType sFormatMultiInterleaved = 2;
 
+    typedef uint32_t CompressionType;
+    static const CompressionType sCompressionNone = 0;
+    static const CompressionType sCompressionLZ4 = 1;
+    static const CompressionType sCompressionZstd = 2;
+    static const CompressionType sCompressionZlib = 3;
+
     // re-typdefing for aesthetic purposes
     typedef acquisition_id_type AcquisitionIdType; // 8 bytes
     typedef record_id_type RecordIdType; // 8 bytes
@@ -0,0 +1,203 @@
+#include "MonarchVerifier.hpp"
+
+#include "MonarchChecksum.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace monarch
+{
+
+    MonarchVerifier::MonarchVerifier() :
+            fDescriptor( -1 ),
+            fBlocksOffset( 0 ),
+            fOffsets()
+    {
+    }
+    MonarchVerifier::~MonarchVerifier()
+    {
+        if( fDescriptor >= 0 )
+        {
+            close( fDescriptor );
+        }
+    }
+
+    bool MonarchVerifier::Open( const string& aFilename, uint64_t aBlocksOffset )
+    {
+        fDescriptor = open( aFilename.c_str(), O_RDONLY );
+        fBlocksOffset = aBlocksOffset;
+        return fDescriptor >= 0;
+    }
+
+    MonarchVerification MonarchVerifier::Verify( const MonarchFooter* aFooter, unsigned aNThreads )
+    {
+        MonarchVerification tResult;
+        tResult.fNBlocks = 0;
+        tResult.fNBadBlocks = 0;
+        tResult.fFirstBadOffset = 0;
+        tResult.fComplete = true;
+
+        // the index has every block; without one the frames are followed, which reads only a few bytes per block
+        fOffsets.clear();
+        if( aFooter != NULL )
+        {
+            for( unsigned tBlock = 0; tBlock < aFooter->GetNBlocks(); ++tBlock )
+            {
+                fOffsets.push_back( aFooter->GetBlockOffset( tBlock ) );
+            }
+        }
+        else
+        {
+            uint64_t tOffset = 0;
+            MonarchBlockFrame tFrame;
+            while( ReadFrame( tOffset, tFrame ) == true )
+            {
+                fOffsets.push_back( tOffset );
+                tOffset += sizeof(MonarchBlockFrame) + tFrame.fStoredNBytes + sizeof(uint32_t);
+            }
+
+            // the blocks end with an end frame, or with the end of a file that was not closed;
+            // anything else is a frame that was damaged, and the blocks behind it cannot be found
+            off_t tFileNBytes = lseek( fDescriptor, 0, SEEK_END );
+            bool tAtEnd = tFileNBytes >= 0 && fBlocksOffset + tOffset >= (uint64_t) tFileNBytes;
+            bool tEndFrame = tFrame.fRawNBytes == 0 && tFrame.fStoredNBytes == 0 && tFrame.fCompression == 0 && tFrame.fElementNBytes == 0;
+            if( tAtEnd == false && tEndFrame == false )
+            {
+                tResult.fComplete = false;
+            }
+        }
+        tResult.fNBlocks = fOffsets.size();
+        if( fOffsets.empty() == true )
+        {
+            return tResult;
+        }
+
+        if( aNThreads == 0 )
+        {
+            long tNCores = sysconf( _SC_NPROCESSORS_ONLN );
+            aNThreads = tNCores > 0 ? (unsigned) tNCores : 1;
+        }
+        if( aNThreads > fOffsets.size() )
+        {
+            aNThreads = fOffsets.size();
+        }
+
+        // the blocks are dealt out in turn, so the threads read the file front to back together;
+        // the blocks of a thread that could not be started are checked on this one
+        std::vector< Worker > tWorkers( aNThreads );
+        for( unsigned tIndex = 0; tIndex < aNThreads; ++tIndex )
+        {
+            Worker& tWorker = tWorkers[ tIndex ];
+            tWorker.fVerifier = this;
+            tWorker.fFirst = tIndex;
+            tWorker.fStep = aNThreads;
+            tWorker.fNBadBlocks = 0;
+            tWorker.fFirstBadOffset = 0;
+            tWorker.fStarted = tIndex > 0 && pthread_create( &tWorker.fThread, NULL, &MonarchVerifier::Run, &tWorker ) == 0;
+        }
+        for( unsigned tIndex = 0; tIndex < aNThreads; ++tIndex )
+        {
+            if( tWorkers[ tIndex ].fStarted == false )
+            {
+                Execute( tWorkers[ tIndex ] );
+            }
+        }
+        for( unsigned tIndex = 0; tIndex < aNThreads; ++tIndex )
+        {
+            if( tWorkers[ tIndex ].fStarted == true )
+            {
+                pthread_join( tWorkers[ tIndex ].fThread, NULL );
+            }
+        }
+
+        for( unsigned tIndex = 0; tIndex < aNThreads; ++tIndex )
+        {
+            const Worker& tWorker = tWorkers[ tIndex ];
+            if( tWorker.fNBadBlocks > 0 && (tResult.fNBadBlocks == 0 || tWorker.fFirstBadOffset < tResult.fFirstBadOffset) )
+            {
+                tResult.fFirstBadOffset = tWorker.fFirstBadOffset;
+            }
+            tResult.fNBadBlocks += tWorker.fNBadBlocks;
+        }
+        return tResult;
+    }
+
+    void* MonarchVerifier::Run( void* anArgument )
+    {
+        Worker* tWorker = static_cast< Worker* >( anArgument );
+        tWorker->fVerifier->Execute( *tWorker );
+        return NULL;
+    }
+
+    void MonarchVerifier::Execute( Worker& aWorker )
+    {
+        std::vector< byte_type > tBuffer;
+        for( size_t tBlock = aWorker.fFirst; tBlock < fOffsets.size(); tBlock += aWorker.fStep )
+        {
+            if( CheckBlock( fOffsets[ tBlock ], tBuffer ) == false )
+            {
+                if( aWorker.fNBadBlocks == 0 )
+                {
+                    aWorker.fFirstBadOffset = fOffsets[ tBlock ];
+                }
+                ++aWorker.fNBadBlocks;
+            }
+        }
+        return;
+    }
+
+    bool MonarchVerifier::ReadFrame( uint64_t anOffset, MonarchBlockFrame& aFrame )
+    {
+        ssize_t tRead;
+        do
+        {
+            tRead = pread( fDescriptor, &aFrame, sizeof(aFrame), fBlocksOffset + anOffset );
+        }
+        while( tRead < 0 && errno == EINTR );
+        if( tRead != (ssize_t) sizeof(aFrame) )
+        {
+            memset( &aFrame, 0xff, sizeof(aFrame) );
+            return false;
+        }
+        return aFrame.fRawNBytes != 0;
+    }
+
+    bool MonarchVerifier::CheckBlock( uint64_t anOffset, std::vector< byte_type >& aBuffer )
+    {
+        MonarchBlockFrame tFrame;
+        if( ReadFrame( anOffset, tFrame ) == false )
+        {
+            return false;
+        }
+
+        // the stored bytes and the checksum behind them
+        size_t tNBytes = tFrame.fStoredNBytes + sizeof(uint32_t);
+        if( aBuffer.size() < tNBytes )
+        {
+            aBuffer.resize( tNBytes );
+        }
+        size_t tDone = 0;
+        uint64_t tPosition = fBlocksOffset + anOffset + sizeof(MonarchBlockFrame);
+        while( tDone < tNBytes )
+        {
+            ssize_t tRead = pread( fDescriptor, &aBuffer[ tDone ], tNBytes - tDone, tPosition + tDone );
+            if( tRead < 0 && errno == EINTR )
+            {
+                continue;
+            }
+            if( tRead <= 0 )
+            {
+                return false;
+            }
+            tDone += tRead;
+        }
+
+        uint32_t tExpected;
+        memcpy( &tExpected, &aBuffer[ tFrame.fStoredNBytes ], sizeof(tExpected) );
+        uint32_t tChecksum = MonarchChecksum::Crc32c( (const byte_type*) &tFrame, sizeof(MonarchBlockFrame) );
+        return MonarchChecksum::Crc32c( &aBuffer[ 0 ], tFrame.fStoredNBytes, tChecksum ) == tExpected;
+    }
+
+}
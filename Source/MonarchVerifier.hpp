@@ -0,0 +1,73 @@
+#ifndef MONARCHVERIFIER_HPP_
+#define MONARCHVERIFIER_HPP_
+
+#include "MonarchFooter.hpp"
+#include "MonarchIOCompressed.hpp"
+#include "MonarchTypes.hpp"
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+using std::string;
+
+namespace monarch
+{
+
+    //outcome of checking the checksums of a file
+    struct MonarchVerification
+    {
+            //blocks checked
+            uint64_t fNBlocks;
+            //blocks that did not match their checksum, or were cut short
+            uint64_t fNBadBlocks;
+            //offset of the first bad block from the first byte after the header
+            uint64_t fFirstBadOffset;
+            //false if the blocks could not be followed to the end of the file, for example because a frame was damaged
+            bool fComplete;
+    };
+
+    //checks the CRC32C checksums of the blocks of a file written with checksums, on several threads.
+    //the stored bytes are checked as they are in the file, so nothing is decompressed.
+    //the blocks are found from the block index when there is one, and by following their frames otherwise.
+    class MonarchVerifier
+    {
+        public:
+            MonarchVerifier();
+            ~MonarchVerifier();
+
+            //open aFilename, whose blocks start aBlocksOffset bytes into the file
+            bool Open( const string& aFilename, uint64_t aBlocksOffset );
+
+            //check every block on aNThreads threads; 0 uses one thread per core.
+            //aFooter is the block index of the file, or NULL.
+            MonarchVerification Verify( const MonarchFooter* aFooter, unsigned aNThreads );
+
+        private:
+            int fDescriptor;
+            uint64_t fBlocksOffset;
+            std::vector< uint64_t > fOffsets;
+
+            struct Worker
+            {
+                    MonarchVerifier* fVerifier;
+                    unsigned fFirst;
+                    unsigned fStep;
+                    uint64_t fNBadBlocks;
+                    uint64_t fFirstBadOffset;
+                    pthread_t fThread;
+                    bool fStarted;
+            };
+
+            static void* Run( void* anArgument );
+            void Execute( Worker& aWorker );
+
+            //read the frame at anOffset; false at the end of the blocks
+            bool ReadFrame( uint64_t anOffset, MonarchBlockFrame& aFrame );
+            //check the block at anOffset, with aBuffer as scratch space
+            bool CheckBlock( uint64_t anOffset, std::vector< byte_type >& aBuffer );
+    };
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "Monarch.hpp"
+#include "MonarchLogger.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace monarch;
+
+MLOGGER( mlog, "MonarchVerify" );
+
+int main( const int argc, const char** argv )
+{
+    if( argc < 2 )
+    {
+        MINFO( mlog, "usage:\n"
+            << "  MonarchVerify [-j <threads>] <input egg file>\n"
+            << "      -j: (optional) number of threads; defaults to one per core" );
+        return -1;
+    }
+
+    unsigned tFileArg = 1;
+    unsigned tNThreads = 0;
+    if( strcmp( argv[1], "-j" ) == 0 )
+    {
+        if( argc < 4 )
+        {
+            MERROR( mlog, "no filename provided" );
+            return -1;
+        }
+        tNThreads = atoi( argv[2] );
+        tFileArg += 2;
+    }
+
+    const Monarch* tReadTest = Monarch::OpenForReading( argv[tFileArg] );
+    MonarchVerification tResult;
+    try
+    {
+        tReadTest->ReadHeader();
+        tResult = tReadTest->Verify( tNThreads );
+    }
+    catch (MonarchException& e)
+    {
+        MERROR( mlog, "Unable to verify <" << argv[tFileArg] << ">" << "\n\t" << e.what() );
+        delete tReadTest;
+        return -1;
+    }
+    tReadTest->Close();
+    delete tReadTest;
+
+    MINFO( mlog, "block count <" << tResult.fNBlocks << ">" );
+    MINFO( mlog, "bad block count <" << tResult.fNBadBlocks << ">" );
+    if( tResult.fNBadBlocks > 0 )
+    {
+        MERROR( mlog, "first bad block at offset <" << tResult.fFirstBadOffset << "> after the header" );
+    }
+    if( tResult.fComplete == false )
+    {
+        MERROR( mlog, "a damaged frame hides the blocks after block <" << tResult.fNBlocks << ">" );
+    }
+    return tResult.fNBadBlocks == 0 && tResult.fComplete == true ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+#include "MonarchVoltage.hpp"
+
+#include "MonarchException.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define MONARCH_VOLTAGE_X86
+#include <immintrin.h>
+#define MONARCH_FMA __attribute__(( target( "avx2,fma" ) ))
+#endif
+
+namespace monarch
+{
+
+    template< class XType, class XVoltType >
+    static void ConvertScalar( const byte_type* aData, size_t aSize, XVoltType aScale, XVoltType anOffset, XVoltType* aVolts )
+    {
+        XType tCode;
+        for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+        {
+            memcpy( &tCode, aData + tIndex * sizeof(XType), sizeof(XType) );
+            aVolts[ tIndex ] = anOffset + aScale * (XVoltType) tCode;
+        }
+        return;
+    }
+
+#ifdef MONARCH_VOLTAGE_X86
+
+    static MONARCH_FMA void ConvertTwoBytesFMA( const byte_type* aData, size_t aSize, float aScale, float anOffset, float* aVolts )
+    {
+        const __m256 tScale = _mm256_set1_ps( aScale );
+        const __m256 tOffset = _mm256_set1_ps( anOffset );
+        size_t tIndex = 0;
+        for( ; tIndex + 8 <= aSize; tIndex += 8 )
+        {
+            __m128i tCodes = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aData + 2 * tIndex ) );
+            __m256 tValues = _mm256_cvtepi32_ps( _mm256_cvtepu16_epi32( tCodes ) );
+            _mm256_storeu_ps( aVolts + tIndex, _mm256_fmadd_ps( tValues, tScale, tOffset ) );
+        }
+        ConvertScalar< uint16_t, float >( aData + 2 * tIndex, aSize - tIndex, aScale, anOffset, aVolts + tIndex );
+        return;
+    }
+    static MONARCH_FMA void ConvertTwoBytesFMA( const byte_type* aData, size_t aSize, double aScale, double anOffset, double* aVolts )
+    {
+        const __m256d tScale = _mm256_set1_pd( aScale );
+        const __m256d tOffset = _mm256_set1_pd( anOffset );
+        size_t tIndex = 0;
+        for( ; tIndex + 4 <= aSize; tIndex += 4 )
+        {
+            __m128i tCodes = _mm_loadl_epi64( reinterpret_cast< const __m128i* >( aData + 2 * tIndex ) );
+            __m256d tValues = _mm256_cvtepi32_pd( _mm_cvtepu16_epi32( tCodes ) );
+            _mm256_storeu_pd( aVolts + tIndex, _mm256_fmadd_pd( tValues, tScale, tOffset ) );
+        }
+        ConvertScalar< uint16_t, double >( aData + 2 * tIndex, aSize - tIndex, aScale, anOffset, aVolts + tIndex );
+        return;
+    }
+
+    //the codes are converted as signed integers, so these are only used for bit depths below 32
+    static MONARCH_FMA void ConvertFourBytesFMA( const byte_type* aData, size_t aSize, float aScale, float anOffset, float* aVolts )
+    {
+        const __m256 tScale = _mm256_set1_ps( aScale );
+        const __m256 tOffset = _mm256_set1_ps( anOffset );
+        size_t tIndex = 0;
+        for( ; tIndex + 8 <= aSize; tIndex += 8 )
+        {
+            __m256i tCodes = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( aData + 4 * tIndex ) );
+            _mm256_storeu_ps( aVolts + tIndex, _mm256_fmadd_ps( _mm256_cvtepi32_ps( tCodes ), tScale, tOffset ) );
+        }
+        ConvertScalar< uint32_t, float >( aData + 4 * tIndex, aSize - tIndex, aScale, anOffset, aVolts + tIndex );
+        return;
+    }
+    static MONARCH_FMA void ConvertFourBytesFMA( const byte_type* aData, size_t aSize, double aScale, double anOffset, double* aVolts )
+    {
+        const __m256d tScale = _mm256_set1_pd( aScale );
+        const __m256d tOffset = _mm256_set1_pd( anOffset );
+        size_t tIndex = 0;
+        for( ; tIndex + 4 <= aSize; tIndex += 4 )
+        {
+            __m128i tCodes = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aData + 4 * tIndex ) );
+            _mm256_storeu_pd( aVolts + tIndex, _mm256_fmadd_pd( _mm256_cvtepi32_pd( tCodes ), tScale, tOffset ) );
+        }
+        ConvertScalar< uint32_t, double >( aData + 4 * tIndex, aSize - tIndex, aScale, anOffset, aVolts + tIndex );
+        return;
+    }
+
+#endif
+
+    MonarchVoltage::MonarchVoltage( const MonarchHeader* aHeader )
+    {
+        Initialize( aHeader->GetDataTypeSize(), aHeader->GetBitDepth(), aHeader->GetVoltageMin(), aHeader->GetVoltageRange() );
+    }
+    MonarchVoltage::MonarchVoltage( unsigned aDataTypeSize, unsigned aBitDepth, double aVoltageMin, double aVoltageRange )
+    {
+        Initialize( aDataTypeSize, aBitDepth, aVoltageMin, aVoltageRange );
+    }
+    MonarchVoltage::~MonarchVoltage()
+    {
+    }
+
+    void MonarchVoltage::Initialize( unsigned aDataTypeSize, unsigned aBitDepth, double aVoltageMin, double aVoltageRange )
+    {
+        if( aDataTypeSize != 1 && aDataTypeSize != 2 && aDataTypeSize != 4 && aDataTypeSize != 8 )
+        {
+            throw MonarchException() << "unable to convert samples with data type size <" << aDataTypeSize << "> to voltages";
+        }
+        if( aBitDepth == 0 || aBitDepth > 8 * aDataTypeSize )
+        {
+            aBitDepth = 8 * aDataTypeSize;
+        }
+
+        fDataTypeSize = aDataTypeSize;
+        fScale = aVoltageRange / ldexp( 1., aBitDepth );
+        fOffset = aVoltageMin;
+
+        for( unsigned tCode = 0; tCode < 256; tCode++ )
+        {
+            fDoubleTable[ tCode ] = fOffset + fScale * (double) tCode;
+            fFloatTable[ tCode ] = (float) fDoubleTable[ tCode ];
+        }
+
+        fFMA = false;
+#ifdef MONARCH_VOLTAGE_X86
+        __builtin_cpu_init();
+        fFMA = __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) && aBitDepth < 32;
+#endif
+        return;
+    }
+
+    void MonarchVoltage::Convert( const byte_type* aData, size_t aSize, float* aVolts ) const
+    {
+        if( fDataTypeSize == 1 )
+        {
+            for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+            {
+                aVolts[ tIndex ] = fFloatTable[ aData[ tIndex ] ];
+            }
+            return;
+        }
+#ifdef MONARCH_VOLTAGE_X86
+        if( fFMA == true && fDataTypeSize == 2 )
+        {
+            ConvertTwoBytesFMA( aData, aSize, (float) fScale, (float) fOffset, aVolts );
+            return;
+        }
+        if( fFMA == true && fDataTypeSize == 4 )
+        {
+            ConvertFourBytesFMA( aData, aSize, (float) fScale, (float) fOffset, aVolts );
+            return;
+        }
+#endif
+        if( fDataTypeSize == 2 ) ConvertScalar< uint16_t, float >( aData, aSize, (float) fScale, (float) fOffset, aVolts );
+        else if( fDataTypeSize == 4 ) ConvertScalar< uint32_t, float >( aData, aSize, (float) fScale, (float) fOffset, aVolts );
+        else ConvertScalar< uint64_t, float >( aData, aSize, (float) fScale, (float) fOffset, aVolts );
+        return;
+    }
+
+    void MonarchVoltage::Convert( const byte_type* aData, size_t aSize, double* aVolts ) const
+    {
+        if( fDataTypeSize == 1 )
+        {
+            for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+            {
+                aVolts[ tIndex ] = fDoubleTable[ aData[ tIndex ] ];
+            }
+            return;
+        }
+#ifdef MONARCH_VOLTAGE_X86
+        if( fFMA == true && fDataTypeSize == 2 )
+        {
+            ConvertTwoBytesFMA( aData, aSize, fScale, fOffset, aVolts );
+            return;
+        }
+        if( fFMA == true && fDataTypeSize == 4 )
+        {
+            ConvertFourBytesFMA( aData, aSize, fScale, fOffset, aVolts );
+            return;
+        }
+#endif
+        if( fDataTypeSize == 2 ) ConvertScalar< uint16_t, double >( aData, aSize, fScale, fOffset, aVolts );
+        else if( fDataTypeSize == 4 ) ConvertScalar< uint32_t, double >( aData, aSize, fScale, fOffset, aVolts );
+        else ConvertScalar< uint64_t, double >( aData, aSize, fScale, fOffset, aVolts );
+        return;
+    }
+
+    double MonarchVoltage::Convert( uint64_t aCode ) const
+    {
+        return fOffset + fScale * (double) aCode;
+    }
+
+    double MonarchVoltage::GetScale() const
+    {
+        return fScale;
+    }
+    double MonarchVoltage::GetOffset() const
+    {
+        return fOffset;
+    }
+
+}
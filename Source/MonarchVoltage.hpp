@@ -0,0 +1,49 @@
+#ifndef MONARCHVOLTAGE_HPP_
+#define MONARCHVOLTAGE_HPP_
+
+#include "MonarchHeader.hpp"
+#include "MonarchTypes.hpp"
+
+#include <cstddef>
+
+namespace monarch
+{
+
+    //converts digitizer codes to volts with the calibration of a header:
+    //  volts = voltage min + code * voltage range / 2^(bit depth)
+    //8-bit data goes through a lookup table; wider data is scaled with fused multiply-adds where the processor has them.
+    class MonarchVoltage
+    {
+        public:
+            MonarchVoltage( const MonarchHeader* aHeader );
+            MonarchVoltage( unsigned aDataTypeSize, unsigned aBitDepth, double aVoltageMin, double aVoltageRange );
+            ~MonarchVoltage();
+
+            //convert aSize samples starting at aData (a record's fData, or the data of several records
+            //laid end to end) and store the voltages in aVolts, which must hold aSize values.
+            void Convert( const byte_type* aData, size_t aSize, float* aVolts ) const;
+            void Convert( const byte_type* aData, size_t aSize, double* aVolts ) const;
+
+            //voltage of a single code
+            double Convert( uint64_t aCode ) const;
+
+            //volts per code and voltage of code 0
+            double GetScale() const;
+            double GetOffset() const;
+
+        private:
+            void Initialize( unsigned aDataTypeSize, unsigned aBitDepth, double aVoltageMin, double aVoltageRange );
+
+            unsigned fDataTypeSize;
+            double fScale;
+            double fOffset;
+            bool fFMA;
+
+            //voltages of every 8-bit code
+            float fFloatTable[ 256 ];
+            double fDoubleTable[ 256 ];
+    };
+
+}
+
+#endif
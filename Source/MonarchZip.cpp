@@ -0,0 +1,399 @@
+#include "MonarchZip.hpp"
+
+#include <cstring>
+#include <pthread.h>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define MONARCH_ZIP_X86
+#include <immintrin.h>
+#define MONARCH_SSE2 __attribute__(( target( "sse2" ) ))
+#define MONARCH_AVX2 __attribute__(( target( "avx2" ) ))
+#define MONARCH_AVX512 __attribute__(( target( "avx512f,avx512bw" ) ))
+#endif
+
+namespace monarch
+{
+
+#ifdef MONARCH_ZIP_X86
+
+    //*****************************************************
+    // sse2 kernels
+    //*****************************************************
+
+    //Low/High interleave the low/high halves of two registers sample by sample;
+    //Gather moves the first channel's samples of an interleaved register to its low half and the second's to its high half.
+    template< class XType >
+    struct MonarchSSE2Lanes;
+
+    template< >
+    struct MonarchSSE2Lanes< uint8_t >
+    {
+            static MONARCH_SSE2 __m128i Low( __m128i aOne, __m128i aTwo ) { return _mm_unpacklo_epi8( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i High( __m128i aOne, __m128i aTwo ) { return _mm_unpackhi_epi8( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i Gather( __m128i aPairs )
+            {
+                return _mm_packus_epi16( _mm_and_si128( aPairs, _mm_set1_epi16( 0x00ff ) ), _mm_srli_epi16( aPairs, 8 ) );
+            }
+    };
+    template< >
+    struct MonarchSSE2Lanes< uint16_t >
+    {
+            static MONARCH_SSE2 __m128i Low( __m128i aOne, __m128i aTwo ) { return _mm_unpacklo_epi16( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i High( __m128i aOne, __m128i aTwo ) { return _mm_unpackhi_epi16( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i Gather( __m128i aPairs )
+            {
+                aPairs = _mm_shufflehi_epi16( _mm_shufflelo_epi16( aPairs, 0xd8 ), 0xd8 );
+                return _mm_shuffle_epi32( aPairs, 0xd8 );
+            }
+    };
+    template< >
+    struct MonarchSSE2Lanes< uint32_t >
+    {
+            static MONARCH_SSE2 __m128i Low( __m128i aOne, __m128i aTwo ) { return _mm_unpacklo_epi32( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i High( __m128i aOne, __m128i aTwo ) { return _mm_unpackhi_epi32( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i Gather( __m128i aPairs ) { return _mm_shuffle_epi32( aPairs, 0xd8 ); }
+    };
+    template< >
+    struct MonarchSSE2Lanes< uint64_t >
+    {
+            static MONARCH_SSE2 __m128i Low( __m128i aOne, __m128i aTwo ) { return _mm_unpacklo_epi64( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i High( __m128i aOne, __m128i aTwo ) { return _mm_unpackhi_epi64( aOne, aTwo ); }
+            static MONARCH_SSE2 __m128i Gather( __m128i aPairs ) { return aPairs; }
+    };
+
+    template< class XType >
+    static MONARCH_SSE2 void ZipSSE2( const size_t aSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 16 / sizeof(XType);
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            __m128i tOne = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aRecordOne + tIndex * sizeof(XType) ) );
+            __m128i tTwo = _mm_loadu_si128( reinterpret_cast< const __m128i* >( aRecordTwo + tIndex * sizeof(XType) ) );
+            __m128i* tOut = reinterpret_cast< __m128i* >( anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+            _mm_storeu_si128( tOut, MonarchSSE2Lanes< XType >::Low( tOne, tTwo ) );
+            _mm_storeu_si128( tOut + 1, MonarchSSE2Lanes< XType >::High( tOne, tTwo ) );
+        }
+        MonarchZipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+    template< class XType >
+    static MONARCH_SSE2 void UnzipSSE2( const size_t aSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 16 / sizeof(XType);
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            const __m128i* tIn = reinterpret_cast< const __m128i* >( anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+            __m128i tFirst = MonarchSSE2Lanes< XType >::Gather( _mm_loadu_si128( tIn ) );
+            __m128i tSecond = MonarchSSE2Lanes< XType >::Gather( _mm_loadu_si128( tIn + 1 ) );
+            _mm_storeu_si128( reinterpret_cast< __m128i* >( aRecordOne + tIndex * sizeof(XType) ), _mm_unpacklo_epi64( tFirst, tSecond ) );
+            _mm_storeu_si128( reinterpret_cast< __m128i* >( aRecordTwo + tIndex * sizeof(XType) ), _mm_unpackhi_epi64( tFirst, tSecond ) );
+        }
+        MonarchUnzipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+    //*****************************************************
+    // avx2 kernels
+    //*****************************************************
+
+    //same as the sse2 helpers, within each 128 bit lane
+    template< class XType >
+    struct MonarchAVX2Lanes;
+
+    template< >
+    struct MonarchAVX2Lanes< uint8_t >
+    {
+            static MONARCH_AVX2 __m256i Low( __m256i aOne, __m256i aTwo ) { return _mm256_unpacklo_epi8( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i High( __m256i aOne, __m256i aTwo ) { return _mm256_unpackhi_epi8( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i Gather( __m256i aPairs )
+            {
+                const __m256i tMask = _mm256_setr_epi8( 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15 );
+                return _mm256_shuffle_epi8( aPairs, tMask );
+            }
+    };
+    template< >
+    struct MonarchAVX2Lanes< uint16_t >
+    {
+            static MONARCH_AVX2 __m256i Low( __m256i aOne, __m256i aTwo ) { return _mm256_unpacklo_epi16( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i High( __m256i aOne, __m256i aTwo ) { return _mm256_unpackhi_epi16( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i Gather( __m256i aPairs )
+            {
+                const __m256i tMask = _mm256_setr_epi8( 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15 );
+                return _mm256_shuffle_epi8( aPairs, tMask );
+            }
+    };
+    template< >
+    struct MonarchAVX2Lanes< uint32_t >
+    {
+            static MONARCH_AVX2 __m256i Low( __m256i aOne, __m256i aTwo ) { return _mm256_unpacklo_epi32( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i High( __m256i aOne, __m256i aTwo ) { return _mm256_unpackhi_epi32( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i Gather( __m256i aPairs ) { return _mm256_shuffle_epi32( aPairs, 0xd8 ); }
+    };
+    template< >
+    struct MonarchAVX2Lanes< uint64_t >
+    {
+            static MONARCH_AVX2 __m256i Low( __m256i aOne, __m256i aTwo ) { return _mm256_unpacklo_epi64( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i High( __m256i aOne, __m256i aTwo ) { return _mm256_unpackhi_epi64( aOne, aTwo ); }
+            static MONARCH_AVX2 __m256i Gather( __m256i aPairs ) { return aPairs; }
+    };
+
+    template< class XType >
+    static MONARCH_AVX2 void ZipAVX2( const size_t aSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 32 / sizeof(XType);
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            __m256i tOne = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( aRecordOne + tIndex * sizeof(XType) ) );
+            __m256i tTwo = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( aRecordTwo + tIndex * sizeof(XType) ) );
+            __m256i tLow = MonarchAVX2Lanes< XType >::Low( tOne, tTwo );
+            __m256i tHigh = MonarchAVX2Lanes< XType >::High( tOne, tTwo );
+            __m256i* tOut = reinterpret_cast< __m256i* >( anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+            _mm256_storeu_si256( tOut, _mm256_permute2x128_si256( tLow, tHigh, 0x20 ) );
+            _mm256_storeu_si256( tOut + 1, _mm256_permute2x128_si256( tLow, tHigh, 0x31 ) );
+        }
+        MonarchZipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+    template< class XType >
+    static MONARCH_AVX2 void UnzipAVX2( const size_t aSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 32 / sizeof(XType);
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            const __m256i* tIn = reinterpret_cast< const __m256i* >( anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+            __m256i tFirst = _mm256_permute4x64_epi64( MonarchAVX2Lanes< XType >::Gather( _mm256_loadu_si256( tIn ) ), 0xd8 );
+            __m256i tSecond = _mm256_permute4x64_epi64( MonarchAVX2Lanes< XType >::Gather( _mm256_loadu_si256( tIn + 1 ) ), 0xd8 );
+            _mm256_storeu_si256( reinterpret_cast< __m256i* >( aRecordOne + tIndex * sizeof(XType) ), _mm256_permute2x128_si256( tFirst, tSecond, 0x20 ) );
+            _mm256_storeu_si256( reinterpret_cast< __m256i* >( aRecordTwo + tIndex * sizeof(XType) ), _mm256_permute2x128_si256( tFirst, tSecond, 0x31 ) );
+        }
+        MonarchUnzipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+    //*****************************************************
+    // avx-512 kernels
+    //*****************************************************
+
+    //same as the sse2 helpers, within each 128 bit lane
+    template< class XType >
+    struct MonarchAVX512Lanes;
+
+    template< >
+    struct MonarchAVX512Lanes< uint8_t >
+    {
+            static MONARCH_AVX512 __m512i Low( __m512i aOne, __m512i aTwo ) { return _mm512_unpacklo_epi8( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i High( __m512i aOne, __m512i aTwo ) { return _mm512_unpackhi_epi8( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i Gather( __m512i aPairs )
+            {
+                const __m512i tMask = _mm512_set4_epi32( 0x0f0d0b09, 0x07050301, 0x0e0c0a08, 0x06040200 );
+                return _mm512_shuffle_epi8( aPairs, tMask );
+            }
+    };
+    template< >
+    struct MonarchAVX512Lanes< uint16_t >
+    {
+            static MONARCH_AVX512 __m512i Low( __m512i aOne, __m512i aTwo ) { return _mm512_unpacklo_epi16( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i High( __m512i aOne, __m512i aTwo ) { return _mm512_unpackhi_epi16( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i Gather( __m512i aPairs )
+            {
+                const __m512i tMask = _mm512_set4_epi32( 0x0f0e0b0a, 0x07060302, 0x0d0c0908, 0x05040100 );
+                return _mm512_shuffle_epi8( aPairs, tMask );
+            }
+    };
+    template< >
+    struct MonarchAVX512Lanes< uint32_t >
+    {
+            static MONARCH_AVX512 __m512i Low( __m512i aOne, __m512i aTwo ) { return _mm512_unpacklo_epi32( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i High( __m512i aOne, __m512i aTwo ) { return _mm512_unpackhi_epi32( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i Gather( __m512i aPairs ) { return _mm512_shuffle_epi32( aPairs, (_MM_PERM_ENUM) 0xd8 ); }
+    };
+    template< >
+    struct MonarchAVX512Lanes< uint64_t >
+    {
+            static MONARCH_AVX512 __m512i Low( __m512i aOne, __m512i aTwo ) { return _mm512_unpacklo_epi64( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i High( __m512i aOne, __m512i aTwo ) { return _mm512_unpackhi_epi64( aOne, aTwo ); }
+            static MONARCH_AVX512 __m512i Gather( __m512i aPairs ) { return aPairs; }
+    };
+
+    template< class XType >
+    static MONARCH_AVX512 void ZipAVX512( const size_t aSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 64 / sizeof(XType);
+        const __m512i tFirstHalves = _mm512_setr_epi64( 0, 1, 8, 9, 2, 3, 10, 11 );
+        const __m512i tSecondHalves = _mm512_setr_epi64( 4, 5, 12, 13, 6, 7, 14, 15 );
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            __m512i tOne = _mm512_loadu_si512( aRecordOne + tIndex * sizeof(XType) );
+            __m512i tTwo = _mm512_loadu_si512( aRecordTwo + tIndex * sizeof(XType) );
+            __m512i tLow = MonarchAVX512Lanes< XType >::Low( tOne, tTwo );
+            __m512i tHigh = MonarchAVX512Lanes< XType >::High( tOne, tTwo );
+            byte_type* tOut = anInterleavedRecord + 2 * tIndex * sizeof(XType);
+            _mm512_storeu_si512( tOut, _mm512_permutex2var_epi64( tLow, tFirstHalves, tHigh ) );
+            _mm512_storeu_si512( tOut + 64, _mm512_permutex2var_epi64( tLow, tSecondHalves, tHigh ) );
+        }
+        MonarchZipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+    template< class XType >
+    static MONARCH_AVX512 void UnzipAVX512( const size_t aSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord )
+    {
+        const size_t tStep = 64 / sizeof(XType);
+        const __m512i tEven = _mm512_setr_epi64( 0, 2, 4, 6, 8, 10, 12, 14 );
+        const __m512i tOdd = _mm512_setr_epi64( 1, 3, 5, 7, 9, 11, 13, 15 );
+        size_t tIndex = 0;
+        for( ; tIndex + tStep <= aSize; tIndex += tStep )
+        {
+            const byte_type* tIn = anInterleavedRecord + 2 * tIndex * sizeof(XType);
+            __m512i tFirst = MonarchAVX512Lanes< XType >::Gather( _mm512_loadu_si512( tIn ) );
+            __m512i tSecond = MonarchAVX512Lanes< XType >::Gather( _mm512_loadu_si512( tIn + 64 ) );
+            _mm512_storeu_si512( aRecordOne + tIndex * sizeof(XType), _mm512_permutex2var_epi64( tFirst, tEven, tSecond ) );
+            _mm512_storeu_si512( aRecordTwo + tIndex * sizeof(XType), _mm512_permutex2var_epi64( tFirst, tOdd, tSecond ) );
+        }
+        MonarchUnzipSamples< XType >( aSize - tIndex, aRecordOne + tIndex * sizeof(XType), aRecordTwo + tIndex * sizeof(XType), anInterleavedRecord + 2 * tIndex * sizeof(XType) );
+    }
+
+#endif
+
+    //*****************************************************
+    // dispatch
+    //*****************************************************
+
+    //kernels by instruction set and data type size (1, 2, 4, 8)
+    static const MonarchZipFunction sZipFunctions[ 4 ][ 4 ] =
+    {
+        { &MonarchZipSamples< uint8_t >, &MonarchZipSamples< uint16_t >, &MonarchZipSamples< uint32_t >, &MonarchZipSamples< uint64_t > },
+#ifdef MONARCH_ZIP_X86
+        { &ZipSSE2< uint8_t >, &ZipSSE2< uint16_t >, &ZipSSE2< uint32_t >, &ZipSSE2< uint64_t > },
+        { &ZipAVX2< uint8_t >, &ZipAVX2< uint16_t >, &ZipAVX2< uint32_t >, &ZipAVX2< uint64_t > },
+        { &ZipAVX512< uint8_t >, &ZipAVX512< uint16_t >, &ZipAVX512< uint32_t >, &ZipAVX512< uint64_t > }
+#else
+        { NULL, NULL, NULL, NULL },
+        { NULL, NULL, NULL, NULL },
+        { NULL, NULL, NULL, NULL }
+#endif
+    };
+    static const MonarchUnzipFunction sUnzipFunctions[ 4 ][ 4 ] =
+    {
+        { &MonarchUnzipSamples< uint8_t >, &MonarchUnzipSamples< uint16_t >, &MonarchUnzipSamples< uint32_t >, &MonarchUnzipSamples< uint64_t > },
+#ifdef MONARCH_ZIP_X86
+        { &UnzipSSE2< uint8_t >, &UnzipSSE2< uint16_t >, &UnzipSSE2< uint32_t >, &UnzipSSE2< uint64_t > },
+        { &UnzipAVX2< uint8_t >, &UnzipAVX2< uint16_t >, &UnzipAVX2< uint32_t >, &UnzipAVX2< uint64_t > },
+        { &UnzipAVX512< uint8_t >, &UnzipAVX512< uint16_t >, &UnzipAVX512< uint32_t >, &UnzipAVX512< uint64_t > }
+#else
+        { NULL, NULL, NULL, NULL },
+        { NULL, NULL, NULL, NULL },
+        { NULL, NULL, NULL, NULL }
+#endif
+    };
+
+    static pthread_once_t sDetectOnce = PTHREAD_ONCE_INIT;
+    static MonarchZip::InstructionSetType sInstructionSet = MonarchZip::eScalar;
+
+    static void DetectInstructionSet()
+    {
+        sInstructionSet = MonarchZip::eScalar;
+#ifdef MONARCH_ZIP_X86
+        __builtin_cpu_init();
+        if( __builtin_cpu_supports( "sse2" ) )
+        {
+            sInstructionSet = MonarchZip::eSSE2;
+        }
+        if( __builtin_cpu_supports( "avx2" ) )
+        {
+            sInstructionSet = MonarchZip::eAVX2;
+        }
+        if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) )
+        {
+            sInstructionSet = MonarchZip::eAVX512;
+        }
+#endif
+        return;
+    }
+
+    static int WidthIndex( const size_t aDataTypeSize )
+    {
+        switch( aDataTypeSize )
+        {
+            case 1:
+                return 0;
+            case 2:
+                return 1;
+            case 4:
+                return 2;
+            case 8:
+                return 3;
+            default:
+                return -1;
+        }
+    }
+
+    MonarchZip::InstructionSetType MonarchZip::GetInstructionSet()
+    {
+        pthread_once( &sDetectOnce, &DetectInstructionSet );
+        return sInstructionSet;
+    }
+
+    const char* MonarchZip::GetInstructionSetName( const InstructionSetType anInstructionSet )
+    {
+        switch( anInstructionSet )
+        {
+            case eSSE2:
+                return "sse2";
+            case eAVX2:
+                return "avx2";
+            case eAVX512:
+                return "avx512";
+            default:
+                return "scalar";
+        }
+    }
+
+    MonarchZipFunction MonarchZip::GetZip( const size_t aDataTypeSize )
+    {
+        return GetZip( aDataTypeSize, GetInstructionSet() );
+    }
+    MonarchUnzipFunction MonarchZip::GetUnzip( const size_t aDataTypeSize )
+    {
+        return GetUnzip( aDataTypeSize, GetInstructionSet() );
+    }
+
+    MonarchExtractFunction MonarchZip::GetExtract( const size_t aDataTypeSize )
+    {
+        switch( aDataTypeSize )
+        {
+            case 1:
+                return &MonarchExtractSamples< uint8_t >;
+            case 2:
+                return &MonarchExtractSamples< uint16_t >;
+            case 4:
+                return &MonarchExtractSamples< uint32_t >;
+            case 8:
+                return &MonarchExtractSamples< uint64_t >;
+            default:
+                return NULL;
+        }
+    }
+
+    MonarchZipFunction MonarchZip::GetZip( const size_t aDataTypeSize, const InstructionSetType anInstructionSet )
+    {
+        int tWidth = WidthIndex( aDataTypeSize );
+        if( tWidth < 0 || anInstructionSet > GetInstructionSet() )
+        {
+            return NULL;
+        }
+        return sZipFunctions[ anInstructionSet ][ tWidth ];
+    }
+    MonarchUnzipFunction MonarchZip::GetUnzip( const size_t aDataTypeSize, const InstructionSetType anInstructionSet )
+    {
+        int tWidth = WidthIndex( aDataTypeSize );
+        if( tWidth < 0 || anInstructionSet > GetInstructionSet() )
+        {
+            return NULL;
+        }
+        return sUnzipFunctions[ anInstructionSet ][ tWidth ];
+    }
+
+}
@@ -0,0 +1,107 @@
+#ifndef MONARCHZIP_HPP_
+#define MONARCHZIP_HPP_
+
+#include "MonarchTypes.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+namespace monarch
+{
+
+    //interleave aSize samples of aRecordOne and aRecordTwo into anInterleavedRecord
+    typedef void (*MonarchZipFunction)( const size_t aSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord );
+    //split aSize interleaved sample pairs of anInterleavedRecord into aRecordOne and aRecordTwo
+    typedef void (*MonarchUnzipFunction)( const size_t aSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord );
+
+    //copy one channel of aSize interleaved sample pairs, starting at aLane, into aRecord
+    typedef void (*MonarchExtractFunction)( const size_t aSize, byte_type* aRecord, const byte_type* aLane );
+
+    //scalar kernels for samples of type XType (uint8_t, uint16_t, uint32_t or uint64_t).
+    //each sample is moved whole; the vector kernels finish their last few samples with these.
+    template< class XType >
+#ifdef __GNUG__
+    inline void MonarchZipSamples( const size_t aSize, const byte_type* __restrict__ aRecordOne, const byte_type* __restrict__ aRecordTwo, byte_type* __restrict__ anInterleavedRecord )
+#else
+    inline void MonarchZipSamples( const size_t aSize, const byte_type* aRecordOne, const byte_type* aRecordTwo, byte_type* anInterleavedRecord )
+#endif
+    {
+        XType tOne;
+        XType tTwo;
+        for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+        {
+            memcpy( &tOne, aRecordOne + tIndex * sizeof(XType), sizeof(XType) );
+            memcpy( &tTwo, aRecordTwo + tIndex * sizeof(XType), sizeof(XType) );
+            memcpy( anInterleavedRecord + (2 * tIndex) * sizeof(XType), &tOne, sizeof(XType) );
+            memcpy( anInterleavedRecord + (2 * tIndex + 1) * sizeof(XType), &tTwo, sizeof(XType) );
+        }
+    }
+
+    template< class XType >
+#ifdef __GNUG__
+    inline void MonarchUnzipSamples( const size_t aSize, byte_type* __restrict__ aRecordOne, byte_type* __restrict__ aRecordTwo, const byte_type* __restrict__ anInterleavedRecord )
+#else
+    inline void MonarchUnzipSamples( const size_t aSize, byte_type* aRecordOne, byte_type* aRecordTwo, const byte_type* anInterleavedRecord )
+#endif
+    {
+        XType tOne;
+        XType tTwo;
+        for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+        {
+            memcpy( &tOne, anInterleavedRecord + (2 * tIndex) * sizeof(XType), sizeof(XType) );
+            memcpy( &tTwo, anInterleavedRecord + (2 * tIndex + 1) * sizeof(XType), sizeof(XType) );
+            memcpy( aRecordOne + tIndex * sizeof(XType), &tOne, sizeof(XType) );
+            memcpy( aRecordTwo + tIndex * sizeof(XType), &tTwo, sizeof(XType) );
+        }
+    }
+
+    template< class XType >
+#ifdef __GNUG__
+    inline void MonarchExtractSamples( const size_t aSize, byte_type* __restrict__ aRecord, const byte_type* __restrict__ aLane )
+#else
+    inline void MonarchExtractSamples( const size_t aSize, byte_type* aRecord, const byte_type* aLane )
+#endif
+    {
+        XType tSample;
+        for( size_t tIndex = 0; tIndex < aSize; tIndex++ )
+        {
+            memcpy( &tSample, aLane + (2 * tIndex) * sizeof(XType), sizeof(XType) );
+            memcpy( aRecord + tIndex * sizeof(XType), &tSample, sizeof(XType) );
+        }
+    }
+
+    //interleave and deinterleave kernels for each data type size.
+    //the vector kernels are picked from what the processor supports the first time they are asked for;
+    //the scalar kernels are used everywhere else.
+    class MonarchZip
+    {
+        public:
+            typedef enum
+            {
+                eScalar = 0,
+                eSSE2 = 1,
+                eAVX2 = 2,
+                eAVX512 = 3
+            } InstructionSetType;
+
+            //kernels for aDataTypeSize (1, 2, 4 or 8) with the best instruction set available.
+            //returns NULL for any other data type size.
+            static MonarchZipFunction GetZip( const size_t aDataTypeSize );
+            static MonarchUnzipFunction GetUnzip( const size_t aDataTypeSize );
+
+            //single-channel deinterleave kernel for aDataTypeSize, or NULL
+            static MonarchExtractFunction GetExtract( const size_t aDataTypeSize );
+
+            //kernels for aDataTypeSize with a particular instruction set.
+            //returns NULL if it was not compiled in or the processor does not support it.
+            static MonarchZipFunction GetZip( const size_t aDataTypeSize, const InstructionSetType anInstructionSet );
+            static MonarchUnzipFunction GetUnzip( const size_t aDataTypeSize, const InstructionSetType anInstructionSet );
+
+            //the instruction set used by GetZip and GetUnzip
+            static InstructionSetType GetInstructionSet();
+            static const char* GetInstructionSetName( const InstructionSetType anInstructionSet );
+    };
+
+}
+
+#endif